@@ -29,6 +29,11 @@
 //#include <cstring>
 #include <dirent.h>
 #include <map>
+#include <algorithm>
+#ifdef TARGET_POSIX
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #include <SDL/SDL.h>
 #include <SDL/SDL_image.h>
@@ -186,7 +191,7 @@ void CreateSkeletonHeader(CXBTF& xbtf, std::string fullPath)
   CreateSkeletonHeaderImpl(xbtf, fullPath, temp);
 }
 
-CXBTFFrame appendContent(CXBTFWriter &writer, int width, int height, unsigned char *data, unsigned int size, unsigned int format, bool hasAlpha, unsigned int flags)
+CXBTFFrame packContent(int width, int height, unsigned char *data, unsigned int size, unsigned int format, bool hasAlpha, unsigned int flags, std::vector<unsigned char> &output)
 {
   CXBTFFrame frame;
 #ifdef USE_LZO_PACKING
@@ -204,7 +209,7 @@ CXBTFFrame appendContent(CXBTFWriter &writer, int width, int height, unsigned ch
       {
         // compression failed, or compressed size is bigger than uncompressed, so store as uncompressed
         packedSize = size;
-        writer.AppendContent(data, size);
+        output.assign(data, data + size);
       }
       else
       { // success
@@ -212,11 +217,11 @@ CXBTFFrame appendContent(CXBTFWriter &writer, int width, int height, unsigned ch
         if (lzo1x_optimize(packed, packedSize, data, &optimSize, NULL) != LZO_E_OK || optimSize != size)
         { //optimisation failed
           packedSize = size;
-          writer.AppendContent(data, size);
+          output.assign(data, data + size);
         }
         else
         { // success
-          writer.AppendContent(packed, packedSize);
+          output.assign(packed, packed + packedSize);
         }
       }
       delete[] working;
@@ -228,7 +233,7 @@ CXBTFFrame appendContent(CXBTFWriter &writer, int width, int height, unsigned ch
   unsigned int packedSize = size;
 #endif
   {
-    writer.AppendContent(data, size);
+    output.assign(data, data + size);
   }
   frame.SetPackedSize(packedSize);
   frame.SetUnpackedSize(size);
@@ -256,7 +261,7 @@ bool HasAlpha(unsigned char *argb, unsigned int width, unsigned int height)
   return false;
 }
 
-CXBTFFrame createXBTFFrame(SDL_Surface* image, CXBTFWriter& writer, double maxMSE, unsigned int flags)
+CXBTFFrame createXBTFFrame(SDL_Surface* image, std::vector<unsigned char> &output, double maxMSE, unsigned int flags)
 {
   // Convert to ARGB
   SDL_PixelFormat argbFormat;
@@ -347,7 +352,7 @@ CXBTFFrame createXBTFFrame(SDL_Surface* image, CXBTFWriter& writer, double maxMS
   CXBTFFrame frame; 
   if (format)
   {
-    frame = appendContent(writer, width, height, compressed, compressedSize, format, hasAlpha, flags);
+    frame = packContent(width, height, compressed, compressedSize, format, hasAlpha, flags, output);
     if (compressedSize)
       delete[] compressed;
   }
@@ -355,7 +360,7 @@ CXBTFFrame createXBTFFrame(SDL_Surface* image, CXBTFWriter& writer, double maxMS
   {
     // none of the compressed stuff works for us, so we use 32bit texture
     format = XB_FMT_A8R8G8B8;
-    frame = appendContent(writer, width, height, argb, (width * height * 4), format, hasAlpha, flags);
+    frame = packContent(width, height, argb, (width * height * 4), format, hasAlpha, flags, output);
   }
 
   SDL_FreeSurface(argbImage);
@@ -369,18 +374,42 @@ void Usage()
   puts("  -input <dir>     Input directory. Default: current dir");
   puts("  -output <dir>    Output directory/filename. Default: Textures.xpr");
   puts("  -dupecheck       Enable duplicate file detection. Reduces output file size. Default: on");
+  puts("  -no_dupecheck    Disable duplicate file detection.");
+  puts("  -threads <n>     Number of images to process at once. Default: number of cores");
   puts("  -use_lzo         Use lz0 packing.     Default: on");
   puts("  -use_dxt         Use DXT compression. Default: on");
   puts("  -use_none        Use No  compression. Default: off");
 }
 
-static bool checkDupe(struct MD5Context* ctx,
-                      map<string,unsigned int>& hashes,
-                      vector<unsigned int>& dupes, unsigned int pos)
+/*! \brief Output of processing a single input file, prior to it being written to the bundle */
+struct CPackedFile
+{
+  CPackedFile() : loaded(false) {}
+
+  bool loaded;                                   ///< whether the image could be loaded
+  std::string hash;                              ///< md5 of the decoded pixels of all frames
+  std::vector<CXBTFFrame> frames;                ///< empty if a file with the same hash was compressed instead
+  std::vector< std::vector<unsigned char> > data; ///< packed data of each frame
+};
+
+struct CPackContext
+{
+  std::string inputDir;
+  std::vector<CXBTFFile> *files;
+  std::vector<CPackedFile> packed;
+  double maxMSE;
+  unsigned int flags;
+  bool dupecheck;
+  std::map<std::string, size_t> compressed; ///< hash -> index of the file that compressed it
+#ifdef TARGET_POSIX
+  pthread_mutex_t lock;                     ///< guards compressed and the work queue
+#endif
+};
+
+static std::string hashToString(struct MD5Context* ctx)
 {
-  unsigned char digest[17];
+  unsigned char digest[16];
   MD5Final(digest,ctx);
-  digest[16] = 0;
   char hex[33];
   sprintf(hex, "%02X%02X%02X%02X%02X%02X%02X%02X"\
       "%02X%02X%02X%02X%02X%02X%02X%02X", digest[0], digest[1], digest[2],
@@ -388,30 +417,189 @@ static bool checkDupe(struct MD5Context* ctx,
       digest[9], digest[10], digest[11], digest[12], digest[13], digest[14],
       digest[15]);
   hex[32] = 0;
-  map<string,unsigned int>::iterator it = hashes.find(hex);
-  if (it != hashes.end())
-  {
-    dupes[pos] = it->second; 
+  return hex;
+}
+
+// returns true if this file is the first to claim its hash, and so should be compressed
+static bool claimHash(size_t index, CPackContext &context)
+{
+  if (!context.dupecheck)
     return true;
+
+#ifdef TARGET_POSIX
+  pthread_mutex_lock(&context.lock);
+#endif
+  bool claimed = context.compressed.insert(make_pair(context.packed[index].hash, index)).second;
+#ifdef TARGET_POSIX
+  pthread_mutex_unlock(&context.lock);
+#endif
+  return claimed;
+}
+
+// decodes a single file once, hashes its pixels and, unless a file with the same
+// pixels has already been claimed, compresses its frames.
+// touches only packed[index] outside of the lock so may be run for different files at once.
+static void processFile(size_t index, CPackContext &context)
+{
+  CXBTFFile& file = (*context.files)[index];
+  CPackedFile& packed = context.packed[index];
+  std::string fullPath = context.inputDir + file.GetPath();
+
+  struct MD5Context ctx;
+  MD5Init(&ctx);
+  if (!IsGIF(fullPath.c_str()))
+  {
+    // Load the image
+    SDL_Surface* image = IMG_Load(fullPath.c_str());
+    if (!image)
+      return;
+
+    if (context.dupecheck)
+    {
+      MD5Update(&ctx,(const uint8_t*)image->pixels,image->h*image->pitch);
+      packed.hash = hashToString(&ctx);
+    }
+    if (claimHash(index, context))
+    {
+      packed.data.resize(1);
+      packed.frames.push_back(createXBTFFrame(image, packed.data[0], context.maxMSE, context.flags));
+    }
+    SDL_FreeSurface(image);
   }
+  else
+  {
+    int gnAG = AG_LoadGIF(fullPath.c_str(), NULL, 0);
+    AG_Frame* gpAG = new AG_Frame[gnAG];
+    AG_LoadGIF(fullPath.c_str(), gpAG, gnAG);
+
+    if (context.dupecheck)
+    {
+      for (int j = 0; j < gnAG; j++)
+        MD5Update(&ctx,
+          (const uint8_t*)gpAG[j].surface->pixels,
+          gpAG[j].surface->h * gpAG[j].surface->pitch);
+      packed.hash = hashToString(&ctx);
+    }
+    if (claimHash(index, context))
+    {
+      packed.data.resize(gnAG);
+      for (int j = 0; j < gnAG; j++)
+      {
+        CXBTFFrame frame = createXBTFFrame(gpAG[j].surface, packed.data[j], context.maxMSE, context.flags);
+        frame.SetDuration(gpAG[j].delay);
+        packed.frames.push_back(frame);
+      }
+    }
+    AG_FreeSurfaces(gpAG, gnAG);
+    delete [] gpAG;
+  }
+  packed.loaded = true;
+}
 
-  hashes.insert(make_pair(hex,pos));
-  dupes[pos] = pos;
+struct CWorkQueue
+{
+  CPackContext *context;
+  size_t count;
+  size_t next;
+};
 
-  return false;
+static void *workerThread(void *arg)
+{
+  CWorkQueue *queue = (CWorkQueue *)arg;
+  while (true)
+  {
+#ifdef TARGET_POSIX
+    pthread_mutex_lock(&queue->context->lock);
+#endif
+    size_t item = queue->next++;
+#ifdef TARGET_POSIX
+    pthread_mutex_unlock(&queue->context->lock);
+#endif
+    if (item >= queue->count)
+      break;
+    processFile(item, *queue->context);
+  }
+  return NULL;
 }
 
-int createBundle(const std::string& InputDir, const std::string& OutputFile, double maxMSE, unsigned int flags, bool dupecheck)
+// runs processFile over all files using up to numThreads threads
+static void processFiles(CPackContext &context, unsigned int numThreads)
+{
+  CWorkQueue queue;
+  queue.context = &context;
+  queue.count = context.packed.size();
+  queue.next = 0;
+#ifdef TARGET_POSIX
+  pthread_mutex_init(&context.lock, NULL);
+  std::vector<pthread_t> threads;
+  for (unsigned int i = 1; i < numThreads && i < queue.count; i++)
+  {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, workerThread, &queue) == 0)
+      threads.push_back(thread);
+  }
+#endif
+  workerThread(&queue);
+#ifdef TARGET_POSIX
+  for (size_t i = 0; i < threads.size(); i++)
+    pthread_join(threads[i], NULL);
+  pthread_mutex_destroy(&context.lock);
+#endif
+}
+
+static bool sortByPath(const CXBTFFile &left, const CXBTFFile &right)
+{
+  return strcmp(const_cast<CXBTFFile&>(left).GetPath(), const_cast<CXBTFFile&>(right).GetPath()) < 0;
+}
+
+int createBundle(const std::string& InputDir, const std::string& OutputFile, double maxMSE, unsigned int flags, bool dupecheck, unsigned int numThreads)
 {
-  map<string,unsigned int> hashes;
-  vector<unsigned int> dupes;
   CXBTF xbtf;
   CreateSkeletonHeader(xbtf, InputDir);
-  dupes.resize(xbtf.GetFiles().size());
-  if (!dupecheck)
+
+  // readdir order is filesystem dependent, so sort to make the output reproducible
+  std::vector<CXBTFFile>& files = xbtf.GetFiles();
+  std::sort(files.begin(), files.end(), sortByPath);
+
+  CPackContext context;
+  context.inputDir = InputDir;
+  context.files = &files;
+  context.packed.resize(files.size());
+  context.maxMSE = maxMSE;
+  context.flags = flags;
+  context.dupecheck = dupecheck;
+
+  // decode every file once, hashing and compressing in the same pass
+  processFiles(context, numThreads);
+
+  vector<unsigned int> dupes;
+  dupes.resize(files.size());
+  for (unsigned int i=0;i<dupes.size();++i)
+    dupes[i] = i;
+
+  if (dupecheck)
   {
-    for (unsigned int i=0;i<dupes.size();++i)
-      dupes[i] = i;
+    // the first file (by path) with given content is the one that is stored. Whichever
+    // thread got to compress it, the packed data is the same, so hand it to that file.
+    map<string,unsigned int> hashes;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+      if (!context.packed[i].loaded)
+        continue;
+      map<string,unsigned int>::iterator it = hashes.find(context.packed[i].hash);
+      if (it != hashes.end())
+        dupes[i] = it->second;
+      else
+      {
+        hashes.insert(make_pair(context.packed[i].hash, (unsigned int)i));
+        size_t compressedBy = context.compressed[context.packed[i].hash];
+        if (compressedBy != i)
+        {
+          context.packed[i].frames.swap(context.packed[compressedBy].frames);
+          context.packed[i].data.swap(context.packed[compressedBy].data);
+        }
+      }
+    }
   }
 
   CXBTFWriter writer(xbtf, OutputFile);
@@ -421,96 +609,51 @@ int createBundle(const std::string& InputDir, const std::string& OutputFile, dou
     return 1;
   }
 
-  std::vector<CXBTFFile>& files = xbtf.GetFiles();
+  // write out in file order so the bundle is identical however many threads were used
   for (size_t i = 0; i < files.size(); i++)
   {
-    struct MD5Context ctx;
-    MD5Init(&ctx);
     CXBTFFile& file = files[i];
-
-    std::string fullPath = InputDir;
-    fullPath += file.GetPath();
+    CPackedFile& packed = context.packed[i];
 
     std::string output = file.GetPath();
     output = output.substr(0, 40);
     while (output.size() < 46)
       output += ' ';
-    if (!IsGIF(fullPath.c_str()))
-    {
-      // Load the image
-      SDL_Surface* image = IMG_Load(fullPath.c_str());
-      if (!image)
-      {
-        printf("...unable to load image %s\n", file.GetPath());
-        continue;
-      }
-
-      bool skip=false;
-      printf("%s", output.c_str());
-      if (dupecheck)
-      {
-        MD5Update(&ctx,(const uint8_t*)image->pixels,image->h*image->pitch);
-        if (checkDupe(&ctx,hashes,dupes,i))
-        {
-          printf("****  duplicate of %s\n", files[dupes[i]].GetPath());
-          file.GetFrames().insert(file.GetFrames().end(),
-            files[dupes[i]].GetFrames().begin(), files[dupes[i]].GetFrames().end());
-          skip = true;
-        }
-      }
 
-      if (!skip)
-      {
-        CXBTFFrame frame = createXBTFFrame(image, writer, maxMSE, flags);
-
-        printf("%s%c (%d,%d @ %"PRIu64" bytes)\n", GetFormatString(frame.GetFormat()), frame.HasAlpha() ? ' ' : '*',
-          frame.GetWidth(), frame.GetHeight(), frame.GetUnpackedSize());
-
-        file.SetLoop(0);
-        file.GetFrames().push_back(frame);
-      }
-      SDL_FreeSurface(image);
+    if (!packed.loaded)
+    {
+      printf("...unable to load image %s\n", file.GetPath());
+      continue;
     }
-    else
+
+    file.SetLoop(0);
+    if (dupes[i] != i)
     {
-      int gnAG = AG_LoadGIF(fullPath.c_str(), NULL, 0);
-      AG_Frame* gpAG = new AG_Frame[gnAG];
-      AG_LoadGIF(fullPath.c_str(), gpAG, gnAG);
+      printf("%s****  duplicate of %s\n", output.c_str(), files[dupes[i]].GetPath());
+      file.GetFrames() = files[dupes[i]].GetFrames();
+      continue;
+    }
 
+    bool animated = IsGIF(file.GetPath());
+    if (animated)
       printf("%s\n", output.c_str());
-      bool skip=false;
-      if (dupecheck)
-      {
-        for (int j = 0; j < gnAG; j++)
-          MD5Update(&ctx,
-            (const uint8_t*)gpAG[j].surface->pixels,
-            gpAG[j].surface->h * gpAG[j].surface->pitch);
-
-        if (checkDupe(&ctx,hashes,dupes,i))
-        {
-          printf("****  duplicate of %s\n", files[dupes[i]].GetPath());
-          file.GetFrames().insert(file.GetFrames().end(),
-            files[dupes[i]].GetFrames().begin(), files[dupes[i]].GetFrames().end());
-          skip = true;
-        }
-      }
-
-      if (!skip)
+    for (size_t j = 0; j < packed.frames.size(); j++)
+    {
+      CXBTFFrame& frame = packed.frames[j];
+      if (!packed.data[j].empty() && !writer.AppendContent(&packed.data[j][0], packed.data[j].size()))
       {
-        for (int j = 0; j < gnAG; j++)
-        {
-          printf("    frame %4i                                ", j);
-          CXBTFFrame frame = createXBTFFrame(gpAG[j].surface, writer, maxMSE, flags);
-          frame.SetDuration(gpAG[j].delay);
-          file.GetFrames().push_back(frame);
-          printf("%s%c (%d,%d @ %"PRIu64" bytes)\n", GetFormatString(frame.GetFormat()), frame.HasAlpha() ? ' ' : '*',
-            frame.GetWidth(), frame.GetHeight(), frame.GetUnpackedSize());
-        }
+        printf("Error writing content of %s\n", file.GetPath());
+        return 1;
       }
-      AG_FreeSurfaces(gpAG, gnAG);
-      delete [] gpAG;
+      std::vector<unsigned char>().swap(packed.data[j]);
 
-      file.SetLoop(0);
+      if (animated)
+        printf("    frame %4i                                ", (int)j);
+      else
+        printf("%s", output.c_str());
+      printf("%s%c (%d,%d @ %" PRIu64 " bytes)\n", GetFormatString(frame.GetFormat()), frame.HasAlpha() ? ' ' : '*',
+        frame.GetWidth(), frame.GetHeight(), frame.GetUnpackedSize());
+      file.GetFrames().push_back(frame);
     }
   }
 
@@ -537,7 +680,13 @@ int main(int argc, char* argv[])
 #endif
   bool valid = false;
   unsigned int flags = 0;
-  bool dupecheck = false;
+  bool dupecheck = true;
+  unsigned int numThreads = 1;
+#ifdef TARGET_POSIX
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cpus > 1)
+    numThreads = (unsigned int)cpus;
+#endif
   CmdLineArgs args(argc, (const char**)argv);
 
   // setup some defaults, dxt with lzo post packing,
@@ -571,6 +720,16 @@ int main(int argc, char* argv[])
     {
       dupecheck = true;
     }
+    else if (!stricmp(args[i], "-no_dupecheck"))
+    {
+      dupecheck = false;
+    }
+    else if (!stricmp(args[i], "-threads") || !stricmp(args[i], "-t"))
+    {
+      int threads = atoi(args[++i]);
+      if (threads > 0)
+        numThreads = threads;
+    }
     else if (!stricmp(args[i], "-output") || !stricmp(args[i], "-o"))
     {
       OutputFilename = args[++i];
@@ -610,6 +769,12 @@ int main(int argc, char* argv[])
   if (pos != InputDir.length() - 1)
     InputDir += DIR_SEPARATOR;
 
+  // initialise the image loaders up front, as the worker threads would otherwise race to do so
+  int imgFlags = IMG_INIT_JPG | IMG_INIT_PNG;
+  if ((IMG_Init(imgFlags) & imgFlags) != imgFlags)
+    printf("Unable to initialise all image loaders: %s\n", IMG_GetError());
+
   double maxMSE = 1.5;    // HQ only please
-  createBundle(InputDir, OutputFilename, maxMSE, flags, dupecheck);
+  createBundle(InputDir, OutputFilename, maxMSE, flags, dupecheck, numThreads);
+  IMG_Quit();
 }
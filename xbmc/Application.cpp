@@ -59,6 +59,7 @@
 #include "SectionLoader.h"
 #include "cores/DllLoader/DllLoaderContainer.h"
 #include "GUIUserMessages.h"
+#include "guilib/GUIFrameProfiler.h"
 #include "filesystem/Directory.h"
 #include "filesystem/DirectoryCache.h"
 #include "filesystem/StackDirectory.h"
@@ -1494,6 +1495,7 @@ bool CApplication::Initialize()
         g_windowManager.ActivateWindow(g_SkinInfo->GetFirstWindow());
 
       CStereoscopicsManager::Get().Initialize();
+      CGUIFrameProfiler::Instance().SetEnabled(g_advancedSettings.m_guiFrameProfiler);
     }
 
   }
@@ -2043,6 +2045,9 @@ bool CApplication::LoadSkin(const SkinPtr& skin)
     if (bPreviousRenderingState)
       g_windowManager.ActivateWindow(WINDOW_FULLSCREEN_VIDEO);
   }
+
+  // get the windows we've been using so far ready in the background
+  g_windowManager.PreloadLikelyWindows(3);
   return true;
 }
 
@@ -2301,7 +2306,7 @@ void CApplication::Render()
   // reset our info cache - we do this at the end of Render so that it is
   // fresh for the next process(), or after a windowclose animation (where process()
   // isn't called)
-  g_infoManager.ResetCache();
+  g_infoManager.ResetFrameCache();
   lock.Leave();
 
   unsigned int now = XbmcThreads::SystemClockMillis();
@@ -2328,7 +2333,11 @@ void CApplication::Render()
   }
 
   if (flip)
+  {
+    GUIFRAMEPROFILER_SCOPE(SECTION_PRESENT);
     g_graphicsContext.Flip(dirtyRegions);
+  }
+  CGUIFrameProfiler::Instance().EndFrame();
 
   m_lastFrameTime = XbmcThreads::SystemClockMillis();
   CTimeUtils::UpdateFrameTime(flip);
@@ -2900,6 +2909,7 @@ void CApplication::FrameMove(bool processEvents, bool processGUI)
 
   if (processEvents)
   {
+    GUIFRAMEPROFILER_SCOPE(SECTION_INPUT);
     // currently we calculate the repeat time (ie time from last similar keypress) just global as fps
     float frameTime = m_frameTime.GetElapsedSeconds();
     m_frameTime.StartZero();
@@ -5155,7 +5165,7 @@ void CApplication::ProcessSlow()
   if (!m_pPlayer->IsPlayingVideo())
     g_largeTextureManager.CleanupUnusedImages();
 
-  g_TextureManager.FreeUnusedTextures(5000);
+  g_TextureManager.FreeUnusedTextures(g_advancedSettings.m_guiUnusedTextureMemory * 1024 * 1024);
 
 #ifdef HAS_DVD_DRIVE
   // checks whats in the DVD drive and tries to autostart the content (xbox games, dvd, cdda, avi files...)
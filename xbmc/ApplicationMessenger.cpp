@@ -61,7 +61,9 @@
 #include "storage/MediaManager.h"
 #include "guilib/LocalizeStrings.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 #include "URL.h"
+#include "GUIUserMessages.h"
 
 #include "playlists/PlayList.h"
 
@@ -100,6 +102,72 @@ void CDelayedMessage::Process()
 }
 
 
+// number of recycled message nodes kept around for reuse
+#define MAX_POOLED_MESSAGES 64
+// how many queued messages to look ahead for one that supersedes the current one
+#define MAX_COALESCE_LOOKAHEAD 32
+
+CThreadMessageQueue::CThreadMessageQueue()
+{
+  m_head = &m_stub;
+  m_tail = &m_stub;
+}
+
+void CThreadMessageQueue::Push(Node* node)
+{
+  node->next = NULL;
+  Node* prev;
+  do
+  {
+    prev = m_head;
+  } while (cas((volatile long*)&m_head, (long)prev, (long)node) != (long)prev);
+
+  // until this link is made the consumer can't see node, or anything pushed after it
+  cas((volatile long*)&prev->next, 0, (long)node);
+}
+
+CThreadMessageQueue::Node* CThreadMessageQueue::Pop()
+{
+  Node* tail = m_tail;
+  Node* next = tail->next;
+  if (tail == &m_stub)
+  {
+    if (!next)
+      return NULL;
+    m_tail = tail = next;
+    next = next->next;
+  }
+
+  if (next)
+  {
+    m_tail = next;
+    return tail;
+  }
+
+  // tail is the last node we can see, if a producer is halfway
+  // through pushing behind it we get to it next time around
+  if (tail != m_head)
+    return NULL;
+
+  // tail really is the last node, push the stub behind it so it can be taken
+  Push(&m_stub);
+  next = tail->next;
+  if (next)
+  {
+    m_tail = next;
+    return tail;
+  }
+  return NULL;
+}
+
+CThreadMessageQueue::Node* CThreadMessageQueue::Next(Node* node /* = NULL */) const
+{
+  Node* next = node ? node->next : m_tail;
+  if (next == &m_stub)
+    next = next->next;
+  return next;
+}
+
 CApplicationMessenger& CApplicationMessenger::Get()
 {
   return s_messenger;
@@ -107,123 +175,232 @@ CApplicationMessenger& CApplicationMessenger::Get()
 
 CApplicationMessenger::CApplicationMessenger()
 {
+  m_pool = NULL;
+  m_poolSize = 0;
+  m_poolLock = 0;
 }
 
 CApplicationMessenger::~CApplicationMessenger()
 {
   Cleanup();
+
+  while (m_pool)
+  {
+    CThreadMessageQueue::Node* node = m_pool;
+    m_pool = node->next;
+    delete node;
+  }
 }
 
 void CApplicationMessenger::Cleanup()
 {
   CSingleLock lock (m_critSection);
 
-  while (m_vecMessages.size() > 0)
+  CThreadMessageQueue* queues[] = { &m_messages, &m_windowMessages };
+  for (unsigned int i = 0; i < sizeof(queues) / sizeof(queues[0]); i++)
   {
-    ThreadMessage* pMsg = m_vecMessages.front();
-
-    if (pMsg->waitEvent)
-      pMsg->waitEvent->Set();
-
-    delete pMsg;
-    m_vecMessages.pop();
+    CThreadMessageQueue::Node* node;
+    while ((node = queues[i]->Pop()) != NULL)
+    {
+      if (node->wait)
+        node->done.Set();
+      ReleaseNode(node);
+    }
   }
+}
 
-  while (m_vecWindowMessages.size() > 0)
+CThreadMessageQueue::Node* CApplicationMessenger::AllocNode()
+{
+  CThreadMessageQueue::Node* node = NULL;
   {
-    ThreadMessage* pMsg = m_vecWindowMessages.front();
-
-    if (pMsg->waitEvent)
-      pMsg->waitEvent->Set();
-
-    delete pMsg;
-    m_vecWindowMessages.pop();
+    CAtomicSpinLock lock(m_poolLock);
+    if (m_pool)
+    {
+      node = m_pool;
+      m_pool = node->next;
+      m_poolSize--;
+    }
   }
+
+  if (!node)
+    node = new CThreadMessageQueue::Node();
+  node->done.Reset();
+  return node;
 }
 
-void CApplicationMessenger::SendMessage(ThreadMessage& message, bool wait)
+void CApplicationMessenger::FreeNode(CThreadMessageQueue::Node* node)
 {
-  message.waitEvent.reset();
-  boost::shared_ptr<CEvent> waitEvent;
-  if (wait)
-  { // check that we're not being called from our application thread, else we'll be waiting
-    // forever!
-    if (!g_application.IsCurrentThread())
-    {
-      message.waitEvent.reset(new CEvent(true));
-      waitEvent = message.waitEvent;
-    }
-    else
+  // drop what the message references but keep the allocated string
+  // and vector buffers around for the next message that needs them
+  node->msg.strParam.clear();
+  node->msg.params.clear();
+  node->msg.waitEvent.reset();
+  node->msg.lpVoid = NULL;
+
+  {
+    CAtomicSpinLock lock(m_poolLock);
+    if (m_poolSize < MAX_POOLED_MESSAGES)
     {
-      //OutputDebugString("Attempting to wait on a SendMessage() from our application thread will cause lockup!\n");
-      //OutputDebugString("Sending immediately\n");
-      ProcessMessage(&message);
+      node->next = m_pool;
+      m_pool = node;
+      m_poolSize++;
       return;
     }
   }
+  delete node;
+}
 
-  CSingleLock lock (m_critSection);
+void CApplicationMessenger::ReleaseNode(CThreadMessageQueue::Node* node)
+{
+  // a waiting sender may see done set and let go while we're still inside Set(),
+  // so whichever of the two is last recycles the node
+  if (AtomicDecrement(&node->refs) == 0)
+    FreeNode(node);
+}
 
-  if (g_application.m_bStop)
-  {
-    if (message.waitEvent)
-      message.waitEvent.reset();
+void CApplicationMessenger::SendMessage(ThreadMessage& message, bool wait)
+{
+  message.waitEvent.reset();
+  if (wait && g_application.IsCurrentThread())
+  { // we're being called from our application thread, waiting here would
+    // wait forever, so process the message immediately
+    ProcessMessage(&message);
     return;
   }
 
-  ThreadMessage* msg = new ThreadMessage();
-  msg->dwMessage = message.dwMessage;
-  msg->param1   = message.param1;
-  msg->param2   = message.param2;
-  msg->waitEvent = message.waitEvent;
-  msg->lpVoid = message.lpVoid;
-  msg->strParam = message.strParam;
-  msg->params = message.params;
-
-  if (msg->dwMessage == TMSG_DIALOG_DOMODAL)
-    m_vecWindowMessages.push(msg);
+  if (g_application.m_bStop)
+    return;
+
+  CThreadMessageQueue::Node* node = AllocNode();
+  node->msg.dwMessage = message.dwMessage;
+  node->msg.param1    = message.param1;
+  node->msg.param2    = message.param2;
+  node->msg.lpVoid    = message.lpVoid;
+  node->msg.strParam  = message.strParam;
+  node->msg.params    = message.params;
+  node->wait          = wait;
+  node->refs          = wait ? 2 : 1;
+
+  if (node->msg.dwMessage == TMSG_DIALOG_DOMODAL)
+    m_windowMessages.Push(node);
   else
-    m_vecMessages.push(msg);
-  lock.Leave();  // this releases the lock on the vec of messages and
-                 //   allows the ProcessMessage to execute and therefore
-                 //   delete the message itself. Therefore any accesss
-                 //   of the message itself after this point consittutes
-                 //   a race condition (yarc - "yet another race condition")
-                 //
-  if (waitEvent) // ... it just so happens we have a spare reference to the
-                 //  waitEvent ... just for such contingencies :)
-  { 
+    m_messages.Push(node);
+
+  // unless we wait for it, the node now belongs to the thread processing
+  // the messages and may already be processed and recycled, so any access
+  // of it after this point constitutes a race condition
+  if (wait)
+  {
     // ensure the thread doesn't hold the graphics lock
     CSingleExit exit(g_graphicsContext);
-    waitEvent->Wait();
+    node->done.Wait();
+    ReleaseNode(node);
   }
 }
 
 void CApplicationMessenger::ProcessMessages()
 {
   // process threadmessages
+  ProcessQueue(m_messages);
+}
+
+void CApplicationMessenger::ProcessQueue(CThreadMessageQueue &queue)
+{
   CSingleLock lock (m_critSection);
-  while (m_vecMessages.size() > 0)
+  CThreadMessageQueue::Node* node;
+  //first remove the message from the queue, else the message could be processed more then once
+  while ((node = queue.Pop()) != NULL)
   {
-    ThreadMessage* pMsg = m_vecMessages.front();
-    //first remove the message from the queue, else the message could be processed more then once
-    m_vecMessages.pop();
+    bool superseded = !node->wait && IsSuperseded(queue, node->msg);
 
     //Leave here as the message might make another
     //thread call processmessages or sendmessage
+    lock.Leave();
 
-    boost::shared_ptr<CEvent> waitEvent = pMsg->waitEvent; 
-    lock.Leave(); // <- see the large comment in SendMessage ^
+    if (superseded)
+      DiscardMessage(node->msg);
+    else
+      ProcessMessage(&node->msg);
 
-    ProcessMessage(pMsg);
-    if (waitEvent)
-      waitEvent->Set();
-    delete pMsg;
+    if (node->wait)
+      node->done.Set();
+    ReleaseNode(node);
 
     lock.Enter();
   }
 }
 
+/*! \brief Whether processing a GUI message twice in a row has the same effect as processing it once.
+ These are the refresh style messages that are typically sent in bursts, e.g. one per updated item.
+ */
+static bool IsRefreshMessage(const CGUIMessage &message)
+{
+  if (message.GetPointer())
+    return false;
+
+  int msg = message.GetMessage();
+  if (msg == GUI_MSG_NOTIFY_ALL)
+    msg = message.GetParam1();
+
+  switch (msg)
+  {
+    case GUI_MSG_REFRESH_THUMBS:
+    case GUI_MSG_REFRESH_LIST:
+    case GUI_MSG_UPDATE:
+    case GUI_MSG_UPDATE_SOURCES:
+    case GUI_MSG_UPDATE_PATH:
+    case GUI_MSG_UPDATE_ITEM:
+    case GUI_MSG_PLAYLIST_CHANGED:
+      return true;
+  }
+  return false;
+}
+
+static bool IsSameMessage(const CGUIMessage &a, const CGUIMessage &b)
+{
+  if (a.GetMessage() != b.GetMessage() || a.GetSenderId() != b.GetSenderId() ||
+      a.GetControlId() != b.GetControlId() || a.GetParam1() != b.GetParam1() ||
+      a.GetParam2() != b.GetParam2() || a.GetItem() != b.GetItem() ||
+      a.GetLabel() != b.GetLabel() || a.GetNumStringParams() != b.GetNumStringParams())
+    return false;
+
+  for (size_t i = 0; i < a.GetNumStringParams(); i++)
+  {
+    if (a.GetStringParam(i) != b.GetStringParam(i))
+      return false;
+  }
+  return true;
+}
+
+bool CApplicationMessenger::IsSuperseded(const CThreadMessageQueue &queue, const ThreadMessage &msg) const
+{
+  // an identical refresh is queued behind this one, so processing
+  // this one as well would just do the same work twice in a row
+  if (msg.dwMessage != TMSG_GUI_MESSAGE || !msg.lpVoid)
+    return false;
+
+  const CGUIMessage &message = *(const CGUIMessage *)msg.lpVoid;
+  if (!IsRefreshMessage(message))
+    return false;
+
+  CThreadMessageQueue::Node* node = queue.Next();
+  for (unsigned int i = 0; node && i < MAX_COALESCE_LOOKAHEAD; i++, node = queue.Next(node))
+  {
+    if (node->msg.dwMessage == TMSG_GUI_MESSAGE && node->msg.lpVoid &&
+        node->msg.param1 == msg.param1 &&
+        IsSameMessage(message, *(const CGUIMessage *)node->msg.lpVoid))
+      return true;
+  }
+  return false;
+}
+
+void CApplicationMessenger::DiscardMessage(ThreadMessage &msg)
+{
+  if (msg.dwMessage == TMSG_GUI_MESSAGE)
+    delete (CGUIMessage *)msg.lpVoid;
+  msg.lpVoid = NULL;
+}
+
 void CApplicationMessenger::ProcessMessage(ThreadMessage *pMsg)
 {
   switch (pMsg->dwMessage)
@@ -869,26 +1046,8 @@ void CApplicationMessenger::ProcessMessage(ThreadMessage *pMsg)
 
 void CApplicationMessenger::ProcessWindowMessages()
 {
-  CSingleLock lock (m_critSection);
   //message type is window, process window messages
-  while (m_vecWindowMessages.size() > 0)
-  {
-    ThreadMessage* pMsg = m_vecWindowMessages.front();
-    //first remove the message from the queue, else the message could be processed more then once
-    m_vecWindowMessages.pop();
-
-    // leave here in case we make more thread messages from this one
-
-    boost::shared_ptr<CEvent> waitEvent = pMsg->waitEvent;
-    lock.Leave(); // <- see the large comment in SendMessage ^
-
-    ProcessMessage(pMsg);
-    if (waitEvent)
-      waitEvent->Set();
-    delete pMsg;
-
-    lock.Enter();
-  }
+  ProcessQueue(m_windowMessages);
 }
 
 int CApplicationMessenger::SetResponse(CStdString response)
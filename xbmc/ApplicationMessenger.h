@@ -144,6 +144,50 @@ struct ThreadMessageCallback
   void *userptr;
 };
 
+/*! \brief Queue of thread messages that any number of threads may push to while a single thread pops from it.
+ Pushing never takes a lock, and the nodes are owned by the caller so they can be pooled and reused.
+ */
+class CThreadMessageQueue
+{
+public:
+  struct Node
+  {
+    Node() : next(NULL), msg(), done(true), wait(false), refs(0) {}
+
+    Node* volatile next;
+    ThreadMessage msg;
+    CEvent done;         ///< \brief set once msg has been processed, only waited on for synchronous messages
+    bool wait;           ///< \brief whether the sender is waiting for done
+    volatile long refs;  ///< \brief held by the consumer, and by the sender while it waits. The last one to let go recycles the node
+  };
+
+  CThreadMessageQueue();
+
+  /*! \brief Append a node to the queue, may be called from any thread.
+   \param node the node to append, which belongs to the queue until it is popped again.
+   */
+  void Push(Node* node);
+
+  /*! \brief Remove the oldest node from the queue, only call from the consuming thread.
+   \return the oldest node, or NULL if the queue is empty or the oldest node is still being pushed.
+   */
+  Node* Pop();
+
+  /*! \brief Peek at the queued nodes without removing them, only call from the consuming thread.
+   \param node the node to look behind, or NULL to get the oldest queued node.
+   \return the node queued after node, or NULL if there is none.
+   */
+  Node* Next(Node* node = NULL) const;
+
+private:
+  CThreadMessageQueue(const CThreadMessageQueue&);
+  CThreadMessageQueue const& operator=(CThreadMessageQueue const&);
+
+  Node* volatile m_head; ///< \brief most recently pushed node
+  Node* m_tail;          ///< \brief oldest node, only touched by the consumer
+  Node m_stub;           ///< \brief placeholder that keeps the queue non-empty
+};
+
 class CApplicationMessenger;
 namespace xbmcutil
 {
@@ -265,10 +309,20 @@ private:
   CApplicationMessenger(const CApplicationMessenger&);
   CApplicationMessenger const& operator=(CApplicationMessenger const&);
   void ProcessMessage(ThreadMessage *pMsg);
-
-  std::queue<ThreadMessage*> m_vecMessages;
-  std::queue<ThreadMessage*> m_vecWindowMessages;
-  CCriticalSection m_critSection;
+  void ProcessQueue(CThreadMessageQueue &queue);
+  bool IsSuperseded(const CThreadMessageQueue &queue, const ThreadMessage &msg) const;
+  void DiscardMessage(ThreadMessage &msg);
+
+  CThreadMessageQueue::Node* AllocNode();
+  void FreeNode(CThreadMessageQueue::Node* node);
+  void ReleaseNode(CThreadMessageQueue::Node* node);
+
+  CThreadMessageQueue m_messages;
+  CThreadMessageQueue m_windowMessages;
+  CCriticalSection m_critSection; ///< \brief serializes the consumers of the queues, senders never take it
+  CThreadMessageQueue::Node* m_pool; ///< \brief recycled nodes, linked through their next member
+  unsigned int m_poolSize;
+  long m_poolLock;
   CCriticalSection m_critBuffer;
   CStdString bufferResponse;
 };
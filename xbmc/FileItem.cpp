@@ -1539,6 +1539,155 @@ bool CFileItem::IsPath(const std::string& path) const
   return URIUtils::PathEquals(m_strPath, path);
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+/////
+///// CFileItemIndex
+/////
+//////////////////////////////////////////////////////////////////////////////////
+
+CFileItemIndex::CFileItemIndex()
+{
+  m_size = 0;
+  m_occupied = 0;
+}
+
+void CFileItemIndex::Clear()
+{
+  std::vector<Slot>().swap(m_slots);
+  m_size = 0;
+  m_occupied = 0;
+}
+
+void CFileItemIndex::Reserve(size_t count)
+{
+  // keep the load (including deleted slots) at or below a half
+  size_t capacity = 16;
+  while (capacity < (m_size + count) * 2)
+    capacity <<= 1;
+  if (capacity > m_slots.size())
+    Rehash(capacity);
+}
+
+void CFileItemIndex::Insert(const CFileItemPtr &item)
+{
+  if ((m_occupied + 1) * 2 > m_slots.size())
+  { // grow, unless it's mostly deleted slots that rehashing will clear
+    const size_t capacity = (m_size + 1) * 4 > m_slots.size() ? m_slots.size() * 2 : m_slots.size();
+    Rehash(std::max<size_t>(capacity, 16));
+  }
+
+  const std::string &path = item->GetPath();
+  const size_t hash = Hash(path);
+  const size_t mask = m_slots.size() - 1;
+  int deleted = -1;
+  for (size_t i = hash & mask; ; i = (i + 1) & mask)
+  {
+    Slot &slot = m_slots[i];
+    if (slot.state == SlotEmpty)
+    {
+      Slot &target = deleted < 0 ? slot : m_slots[deleted];
+      if (deleted < 0)
+        m_occupied++;
+      target.path = path;
+      target.item = item;
+      target.hash = hash;
+      target.state = SlotUsed;
+      m_size++;
+      return;
+    }
+    if (slot.state == SlotDeleted)
+    {
+      if (deleted < 0)
+        deleted = (int)i;
+    }
+    else if (slot.hash == hash && slot.path == path)
+      return; // keep the first item added for this path
+  }
+}
+
+void CFileItemIndex::Erase(const std::string &path)
+{
+  const int i = FindSlot(path, Hash(path));
+  if (i < 0)
+    return;
+
+  Slot &slot = m_slots[i];
+  slot.path.clear();
+  slot.item.reset();
+  slot.state = SlotDeleted;
+  m_size--;
+}
+
+bool CFileItemIndex::Contains(const std::string &path) const
+{
+  return FindSlot(path, Hash(path)) >= 0;
+}
+
+CFileItemPtr CFileItemIndex::Find(const std::string &path) const
+{
+  const int i = FindSlot(path, Hash(path));
+  if (i < 0)
+    return CFileItemPtr();
+
+  return m_slots[i].item;
+}
+
+size_t CFileItemIndex::Hash(const std::string &path)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261U;
+  for (std::string::const_iterator it = path.begin(); it != path.end(); ++it)
+  {
+    hash ^= (unsigned char)*it;
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+int CFileItemIndex::FindSlot(const std::string &path, size_t hash) const
+{
+  if (m_slots.empty())
+    return -1;
+
+  const size_t mask = m_slots.size() - 1;
+  for (size_t i = hash & mask; ; i = (i + 1) & mask)
+  {
+    const Slot &slot = m_slots[i];
+    if (slot.state == SlotEmpty)
+      return -1;
+    if (slot.state == SlotUsed && slot.hash == hash && slot.path == path)
+      return (int)i;
+  }
+}
+
+void CFileItemIndex::Rehash(size_t capacity)
+{
+  std::vector<Slot> slots(capacity);
+  m_slots.swap(slots);
+  m_size = 0;
+  m_occupied = 0;
+
+  // items were unique by path already, so there's no need to compare them
+  const size_t mask = capacity - 1;
+  for (std::vector<Slot>::iterator it = slots.begin(); it != slots.end(); ++it)
+  {
+    if (it->state != SlotUsed)
+      continue;
+
+    size_t i = it->hash & mask;
+    while (m_slots[i].state != SlotEmpty)
+      i = (i + 1) & mask;
+
+    Slot &slot = m_slots[i];
+    slot.path.swap(it->path);
+    slot.item.swap(it->item);
+    slot.hash = it->hash;
+    slot.state = SlotUsed;
+    m_size++;
+    m_occupied++;
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 /////
 ///// CFileItemList
@@ -1592,16 +1741,14 @@ void CFileItemList::SetFastLookup(bool fastLookup)
   CSingleLock lock(m_lock);
 
   if (fastLookup && !m_fastLookup)
-  { // generate the map
-    m_map.clear();
+  { // generate the index
+    m_index.Clear();
+    m_index.Reserve(m_items.size());
     for (unsigned int i=0; i < m_items.size(); i++)
-    {
-      CFileItemPtr pItem = m_items[i];
-      m_map.insert(MAPFILEITEMSPAIR(pItem->GetPath(), pItem));
-    }
+      m_index.Insert(m_items[i]);
   }
   if (!fastLookup && m_fastLookup)
-    m_map.clear();
+    m_index.Clear();
   m_fastLookup = fastLookup;
 }
 
@@ -1610,7 +1757,7 @@ bool CFileItemList::Contains(const std::string& fileName) const
   CSingleLock lock(m_lock);
 
   if (m_fastLookup)
-    return m_map.find(fileName) != m_map.end();
+    return m_index.Contains(fileName);
 
   // slow method...
   for (unsigned int i = 0; i < m_items.size(); i++)
@@ -1648,7 +1795,7 @@ void CFileItemList::ClearItems()
     item->FreeMemory();
   }
   m_items.clear();
-  m_map.clear();
+  m_index.Clear();
 }
 
 void CFileItemList::Add(const CFileItemPtr &pItem)
@@ -1657,9 +1804,7 @@ void CFileItemList::Add(const CFileItemPtr &pItem)
 
   m_items.push_back(pItem);
   if (m_fastLookup)
-  {
-    m_map.insert(MAPFILEITEMSPAIR(pItem->GetPath(), pItem));
-  }
+    m_index.Insert(pItem);
 }
 
 void CFileItemList::AddFront(const CFileItemPtr &pItem, int itemPosition)
@@ -1675,9 +1820,7 @@ void CFileItemList::AddFront(const CFileItemPtr &pItem, int itemPosition)
     m_items.insert(m_items.begin()+(m_items.size()+itemPosition), pItem);
   }
   if (m_fastLookup)
-  {
-    m_map.insert(MAPFILEITEMSPAIR(pItem->GetPath(), pItem));
-  }
+    m_index.Insert(pItem);
 }
 
 void CFileItemList::Remove(CFileItem* pItem)
@@ -1690,9 +1833,7 @@ void CFileItemList::Remove(CFileItem* pItem)
     {
       m_items.erase(it);
       if (m_fastLookup)
-      {
-        m_map.erase(pItem->GetPath());
-      }
+        m_index.Erase(pItem->GetPath());
       break;
     }
   }
@@ -1706,9 +1847,7 @@ void CFileItemList::Remove(int iItem)
   {
     CFileItemPtr pItem = *(m_items.begin() + iItem);
     if (m_fastLookup)
-    {
-      m_map.erase(pItem->GetPath());
-    }
+      m_index.Erase(pItem->GetPath());
     m_items.erase(m_items.begin() + iItem);
   }
 }
@@ -1717,7 +1856,13 @@ void CFileItemList::Append(const CFileItemList& itemlist)
 {
   CSingleLock lock(m_lock);
 
-  for (int i = 0; i < itemlist.Size(); ++i)
+  // the items are shared rather than copied, so all that's left to save is reallocating
+  const int count = itemlist.Size();
+  m_items.reserve(m_items.size() + count);
+  if (m_fastLookup)
+    m_index.Reserve(count);
+
+  for (int i = 0; i < count; ++i)
     Add(itemlist[i]);
 }
 
@@ -1789,13 +1934,8 @@ CFileItemPtr CFileItemList::Get(const std::string& strPath)
   CSingleLock lock(m_lock);
 
   if (m_fastLookup)
-  {
-    IMAPFILEITEMS it=m_map.find(strPath);
-    if (it != m_map.end())
-      return it->second;
+    return m_index.Find(strPath);
 
-    return CFileItemPtr();
-  }
   // slow method...
   for (unsigned int i = 0; i < m_items.size(); i++)
   {
@@ -1812,13 +1952,8 @@ const CFileItemPtr CFileItemList::Get(const std::string& strPath) const
   CSingleLock lock(m_lock);
 
   if (m_fastLookup)
-  {
-    map<std::string, CFileItemPtr>::const_iterator it=m_map.find(strPath);
-    if (it != m_map.end())
-      return it->second;
+    return m_index.Find(strPath);
 
-    return CFileItemPtr();
-  }
   // slow method...
   for (unsigned int i = 0; i < m_items.size(); i++)
   {
@@ -1846,6 +1981,8 @@ void CFileItemList::Reserve(int iCount)
 {
   CSingleLock lock(m_lock);
   m_items.reserve(iCount);
+  if (m_fastLookup && iCount > (int)m_index.Size())
+    m_index.Reserve(iCount - m_index.Size());
 }
 
 void CFileItemList::Sort(FILEITEMLISTCOMPARISONFUNC func)
@@ -2289,7 +2426,7 @@ void CFileItemList::StackFolders()
   vector<string>::const_iterator strExpression = strFolderRegExps.begin();
   while (strExpression != strFolderRegExps.end())
   {
-    if (!folderRegExp.RegComp(*strExpression))
+    if (!folderRegExp.RegComp(*strExpression, CRegExp::StudyWithJitComp))
       CLog::Log(LOGERROR, "%s: Invalid folder stack RegExp:'%s'", __FUNCTION__, strExpression->c_str());
     else
       folderRegExps.push_back(folderRegExp);
@@ -2380,7 +2517,7 @@ void CFileItemList::StackFiles()
   vector<string>::const_iterator strRegExp = strStackRegExps.begin();
   while (strRegExp != strStackRegExps.end())
   {
-    if (tmpRegExp.RegComp(*strRegExp))
+    if (tmpRegExp.RegComp(*strRegExp, CRegExp::StudyWithJitComp))
     {
       if (tmpRegExp.GetCaptureTotal() == 4)
         stackRegExps.push_back(tmpRegExp);
@@ -3208,7 +3345,7 @@ std::string CFileItem::FindTrailer() const
   vector<string>::const_iterator strRegExp = strMatchRegExps.begin();
   while (strRegExp != strMatchRegExps.end())
   {
-    if (tmpRegExp.RegComp(*strRegExp))
+    if (tmpRegExp.RegComp(*strRegExp, CRegExp::StudyWithJitComp))
     {
       matchRegExps.push_back(tmpRegExp);
     }
@@ -505,22 +505,48 @@ typedef std::vector< CFileItemPtr > VECFILEITEMS;
 typedef std::vector< CFileItemPtr >::iterator IVECFILEITEMS;
 
 /*!
-  \brief A map of pointers to CFileItem
-  \sa CFileItem
+  \brief Index of pointers to CFileItem by path
+  Open addressing hash table with linear probing, used by CFileItemList for
+  fast lookups. As with inserting into a std::map, the first item added for
+  a path is kept.
+  \sa CFileItemList::SetFastLookup
   */
-typedef std::map<std::string, CFileItemPtr > MAPFILEITEMS;
+class CFileItemIndex
+{
+public:
+  CFileItemIndex();
 
-/*!
-  \brief Iterator for MAPFILEITEMS
-  \sa MAPFILEITEMS
-  */
-typedef std::map<std::string, CFileItemPtr >::iterator IMAPFILEITEMS;
+  void Clear();
+  void Reserve(size_t count);
+  void Insert(const CFileItemPtr &item);
+  void Erase(const std::string &path);
+  bool Contains(const std::string &path) const;
+  CFileItemPtr Find(const std::string &path) const;
+  size_t Size() const { return m_size; }
 
-/*!
-  \brief Pair for MAPFILEITEMS
-  \sa MAPFILEITEMS
-  */
-typedef std::pair<std::string, CFileItemPtr > MAPFILEITEMSPAIR;
+private:
+  enum SlotState { SlotEmpty = 0, SlotUsed, SlotDeleted };
+
+  struct Slot
+  {
+    Slot() : hash(0), state(SlotEmpty) {}
+    std::string path;
+    CFileItemPtr item;
+    size_t hash;
+    SlotState state;
+  };
+
+  static size_t Hash(const std::string &path);
+  /*! \brief find the slot of the given path
+   \return index of the slot, or -1 if the path isn't in the index
+   */
+  int FindSlot(const std::string &path, size_t hash) const;
+  void Rehash(size_t capacity);
+
+  std::vector<Slot> m_slots; ///< \brief the table, its size is always a power of two
+  size_t m_size;             ///< \brief number of used slots
+  size_t m_occupied;         ///< \brief number of used and deleted slots, these end probing
+};
 
 typedef bool (*FILEITEMLISTCOMPARISONFUNC) (const CFileItemPtr &pItem1, const CFileItemPtr &pItem2);
 typedef void (*FILEITEMFILLFUNC) (CFileItemPtr &item);
@@ -672,7 +698,7 @@ private:
   void StackFolders();
 
   VECFILEITEMS m_items;
-  MAPFILEITEMS m_map;
+  CFileItemIndex m_index;
   bool m_fastLookup;
   SortDescription m_sortDescription;
   bool m_sortIgnoreFolders;
@@ -125,6 +125,7 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_playerShowCodec = false;
   m_playerShowInfo = false;
   m_fps = 0.0f;
+  m_frameInvalidations = 0;
   ResetLibraryBools();
 }
 
@@ -830,6 +831,27 @@ int CGUIInfoManager::TranslateSingleString(const CStdString &strCondition, bool
   CStdString strTest = strCondition;
   StringUtils::Trim(strTest);
 
+  // skins use the same few conditions and labels over and over, so each
+  // distinct string is only parsed once (per skin load)
+  CSingleLock lock(m_critInfo);
+  map<string, pair<int, bool> >::const_iterator cached = m_translatedStrings.find(strTest);
+  if (cached != m_translatedStrings.end())
+  {
+    if (cached->second.second)
+      listItemDependent = true;
+    return cached->second.first;
+  }
+
+  bool dependent = false;
+  int ret = ParseSingleString(strTest, dependent);
+  if (dependent)
+    listItemDependent = true;
+  m_translatedStrings.insert(make_pair(strTest, make_pair(ret, dependent)));
+  return ret;
+}
+
+int CGUIInfoManager::ParseSingleString(const CStdString &strTest, bool &listItemDependent)
+{
   vector< Property> info;
   SplitInfoString(strTest, info);
 
@@ -2169,14 +2191,6 @@ bool CGUIInfoManager::GetInt(int &value, int info, int contextWindow, const CGUI
   return false;
 }
 
-// functor for comparison InfoPtr's
-struct InfoBoolFinder
-{
-  InfoBoolFinder(const std::string &expression, int context) : m_bool(expression, context) {};
-  bool operator() (const InfoPtr &right) const { return m_bool == *right; };
-  InfoBool m_bool;
-};
-
 INFO::InfoPtr CGUIInfoManager::Register(const CStdString &expression, int context)
 {
   CStdString condition(CGUIInfoLabel::ReplaceLocalize(expression));
@@ -2187,15 +2201,19 @@ INFO::InfoPtr CGUIInfoManager::Register(const CStdString &expression, int contex
 
   CSingleLock lock(m_critInfo);
   // do we have the boolean expression already registered?
-  vector<InfoPtr>::const_iterator i = find_if(m_bools.begin(), m_bools.end(), InfoBoolFinder(condition, context));
-  if (i != m_bools.end())
-    return *i;
+  // (expressions are stored lowercase, see InfoBool)
+  pair<string, int> key(condition, context);
+  StringUtils::ToLower(key.first);
+  map<pair<string, int>, size_t>::const_iterator i = m_boolIndex.find(key);
+  if (i != m_boolIndex.end())
+    return m_bools[i->second];
 
   if (condition.find_first_of("|+[]!") != condition.npos)
     m_bools.push_back(boost::make_shared<InfoExpression>(condition, context));
   else
     m_bools.push_back(boost::make_shared<InfoSingle>(condition, context));
 
+  m_boolIndex[key] = m_bools.size() - 1;
   return m_bools.back();
 }
 
@@ -4283,6 +4301,8 @@ void CGUIInfoManager::Clear()
 {
   CSingleLock lock(m_critInfo);
   m_skinVariableStrings.clear();
+  // translations may refer to skin specific settings
+  m_translatedStrings.clear();
 
   /*
     Erase any info bools that are unused. We do this repeatedly as each run
@@ -4295,6 +4315,10 @@ void CGUIInfoManager::Clear()
     m_bools.erase(i, m_bools.end());
     i = remove_if(m_bools.begin(), m_bools.end(), std::mem_fun_ref(&InfoPtr::unique));
   }
+  // and reindex those that remain
+  m_boolIndex.clear();
+  for (size_t j = 0; j < m_bools.size(); j++)
+    m_boolIndex[make_pair(m_bools[j]->GetExpression(), m_bools[j]->GetContext())] = j;
   // log which ones are used - they should all be gone by now
   for (vector<InfoPtr>::const_iterator i = m_bools.begin(); i != m_bools.end(); ++i)
     CLog::Log(LOGDEBUG, "Infobool '%s' still used by %u instances", (*i)->GetExpression().c_str(), (unsigned int) i->use_count());
@@ -5296,6 +5320,52 @@ void CGUIInfoManager::ResetCache()
     (*i)->SetDirty();
 }
 
+void CGUIInfoManager::ResetFrameCache()
+{
+  // reset any animation triggers as well
+  m_containerMoves.clear();
+  // mark the infobools that may have changed since the last frame as dirty.
+  // The remainder are marked dirty by their source through InvalidateSources()
+  CSingleLock lock(m_critInfo);
+  unsigned int dirty = 0;
+  for (vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+  {
+    if ((*i)->DependsOn(INFO_SOURCE_FRAME))
+    {
+      (*i)->SetDirty();
+      dirty++;
+    }
+  }
+  m_frameInvalidations = dirty;
+}
+
+void CGUIInfoManager::InvalidateSources(unsigned int sources)
+{
+  CSingleLock lock(m_critInfo);
+  for (vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+  {
+    if ((*i)->DependsOn(sources))
+      (*i)->SetDirty();
+  }
+}
+
+unsigned int CGUIInfoManager::GetInfoSources(int condition) const
+{
+  condition = abs(condition);
+  if (condition == SYSTEM_ALWAYS_TRUE || condition == SYSTEM_ALWAYS_FALSE)
+    return INFO_SOURCE_NONE;
+  if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_HAS_MUSICVIDEOS)
+    return INFO_SOURCE_LIBRARY;
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END &&
+      condition - MULTI_INFO_START < (int)m_multiInfo.size())
+  {
+    int info = abs(m_multiInfo[condition - MULTI_INFO_START].m_info);
+    if (info == SKIN_BOOL || info == SKIN_STRING)
+      return INFO_SOURCE_SKINSETTINGS;
+  }
+  return INFO_SOURCE_FRAME;
+}
+
 // Called from tuxbox service thread to update current status
 void CGUIInfoManager::UpdateFromTuxBox()
 {
@@ -5493,6 +5563,7 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
     default:
       break;
   }
+  InvalidateSources(INFO_SOURCE_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -5502,6 +5573,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasTVShows = -1;
   m_libraryHasMusicVideos = -1;
   m_libraryHasMovieSets = -1;
+  InvalidateSources(INFO_SOURCE_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
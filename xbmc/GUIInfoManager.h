@@ -816,7 +816,33 @@ public:
   void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
   void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
 
+  /*! \brief Mark all info bools dirty, forcing them to be re-evaluated
+   \sa ResetFrameCache
+   */
   void ResetCache();
+
+  /*! \brief Mark the info bools that may change from frame to frame dirty.
+   Info bools depending only on sources that publish their changes (skin settings,
+   library flags) keep their cached value until InvalidateSources() is called.
+   */
+  void ResetFrameCache();
+
+  /*! \brief Called by an info source when it changes
+   Marks the info bools depending on any of the given sources dirty.
+   \param sources a combination of INFO::INFO_SOURCE flags
+   */
+  void InvalidateSources(unsigned int sources);
+
+  /*! \brief Get the sources of information a boolean condition depends on
+   \param condition the condition as returned from TranslateSingleString
+   \return a combination of INFO::INFO_SOURCE flags
+   */
+  unsigned int GetInfoSources(int condition) const;
+
+  /*! \brief Number of info bools marked dirty by the last ResetFrameCache() call
+   */
+  unsigned int GetFrameInvalidations() const { return m_frameInvalidations; };
+
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
   CStdString GetItemLabel(const CFileItem *item, int info, std::string *fallback = NULL);
   CStdString GetItemImage(const CFileItem *item, int info, std::string *fallback = NULL);
@@ -854,6 +880,11 @@ protected:
   bool GetBool(int condition, int contextWindow = 0, const CGUIListItem *item=NULL);
   int TranslateSingleString(const CStdString &strCondition, bool &listItemDependent);
 
+  /*! \brief Parse a (trimmed) condition or label into its info id
+   Does the actual work for TranslateSingleString, which caches the results.
+   */
+  int ParseSingleString(const CStdString &strCondition, bool &listItemDependent);
+
   // routines for window retrieval
   bool CheckWindowCondition(CGUIWindow *window, int condition) const;
   CGUIWindow *GetWindowWithCondition(int contextWindow, int condition) const;
@@ -940,10 +971,13 @@ protected:
   unsigned int m_lastFPSTime;
 
   std::map<int, int> m_containerMoves;  // direction of list moving
+  unsigned int m_frameInvalidations;     // info bools marked dirty at the last frame
   int m_nextWindowID;
   int m_prevWindowID;
 
   std::vector<INFO::InfoPtr> m_bools;
+  std::map<std::pair<std::string, int>, size_t> m_boolIndex; // position in m_bools of each (expression, context)
+  std::map<std::string, std::pair<int, bool> > m_translatedStrings; // parsed info id and list item dependency of each string, cleared with the skin
   std::vector<INFO::CSkinVariableString> m_skinVariableStrings;
 
   int m_libraryHasMusic;
@@ -18,12 +18,14 @@
  *
  */
 
+#include <algorithm>
 #include "TextureCache.h"
 #include "TextureCacheJob.h"
 #include "filesystem/File.h"
 #include "profiles/ProfilesManager.h"
 #include "threads/SingleLock.h"
 #include "utils/Crc32.h"
+#include "utils/CPUInfo.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
@@ -39,8 +41,46 @@ CTextureCache &CTextureCache::Get()
   return s_cache;
 }
 
-CTextureCache::CTextureCache() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE)
+CTextureDecodeBudget::CTextureDecodeBudget(bool visible)
 {
+  m_visible = visible;
+  m_acquired = false;
+  m_bytes = 0;
+}
+
+CTextureDecodeBudget::~CTextureDecodeBudget()
+{
+  if (m_acquired)
+    CTextureCache::Get().ReleaseDecodeBudget(m_bytes);
+}
+
+void CTextureDecodeBudget::Acquire(uint64_t bytes)
+{
+  if (m_acquired)
+    return;
+  CTextureCache::Get().AcquireDecodeBudget(bytes, m_visible);
+  m_bytes = bytes;
+  m_acquired = true;
+}
+
+void CTextureDecodeBudget::Update(uint64_t bytes)
+{
+  if (!m_acquired || bytes == m_bytes)
+    return;
+  CTextureCache &cache = CTextureCache::Get();
+  CSingleLock lock(cache.m_budgetSection);
+  cache.m_budgetUsed = cache.m_budgetUsed - m_bytes + bytes;
+  if (bytes < m_bytes)
+    cache.m_budgetCond.notifyAll();
+  m_bytes = bytes;
+}
+
+CTextureCache::CTextureCache() : CJobQueue(false, std::max(1, g_cpuInfo.getCPUCount()), CJob::PRIORITY_LOW_PAUSABLE)
+{
+  m_budgetUsed = 0;
+  m_decoding = 0;
+  m_waitingVisible = 0;
+  m_waitingPrefetch = 0;
 }
 
 CTextureCache::~CTextureCache()
@@ -57,6 +97,10 @@ void CTextureCache::Initialize()
 void CTextureCache::Deinitialize()
 {
   CancelJobs();
+  CTextureCacheStats stats = GetStats();
+  if (stats.decode.count)
+    CLog::Log(LOGDEBUG, "%s - fetch %u/%ums, decode %u/%ums, store %u/%ums (count/avg)", __FUNCTION__,
+              stats.fetch.count, stats.fetch.Average(), stats.decode.count, stats.decode.Average(), stats.store.count, stats.store.Average());
   CSingleLock lock(m_databaseSection);
   m_database.Close();
 }
@@ -283,10 +327,57 @@ void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
   m_completeEvent.Set();
 
   // TODO: call back to the UI indicating that it can update it's image...
-  if (success && g_advancedSettings.m_useDDSFanart && !job->m_details.file.empty())
+  if (success && g_advancedSettings.m_useDDSFanart && !job->m_details.file.empty() && !job->m_createdDDS)
     AddJob(new CTextureDDSJob(GetCachedPath(job->m_details.file)));
 }
 
+void CTextureCache::AcquireDecodeBudget(uint64_t bytes, bool visible)
+{
+  const uint64_t budget = (uint64_t)g_advancedSettings.m_imageDecodeBudget * 1024 * 1024;
+
+  CSingleLock lock(m_budgetSection);
+  unsigned int &waiting = visible ? m_waitingVisible : m_waitingPrefetch;
+  waiting++;
+  while (m_decoding && (m_budgetUsed + bytes > budget || (!visible && m_waitingVisible)))
+    m_budgetCond.wait(lock);
+  waiting--;
+  m_budgetUsed += bytes;
+  m_decoding++;
+}
+
+void CTextureCache::ReleaseDecodeBudget(uint64_t bytes)
+{
+  CSingleLock lock(m_budgetSection);
+  m_budgetUsed -= std::min(bytes, m_budgetUsed);
+  if (m_decoding)
+    m_decoding--;
+  m_budgetCond.notifyAll();
+}
+
+void CTextureCache::RecordStageTime(STAGE stage, unsigned int ms)
+{
+  CSingleLock lock(m_budgetSection);
+  m_stageTimes[stage].Add(ms);
+}
+
+CTextureCacheStats CTextureCache::GetStats() const
+{
+  CTextureCacheStats stats;
+  stats.queued = QueueSize();
+  stats.processing = ProcessingSize();
+
+  CSingleLock lock(m_budgetSection);
+  stats.decoding = m_decoding;
+  stats.waitingVisible = m_waitingVisible;
+  stats.waitingPrefetch = m_waitingPrefetch;
+  stats.budgetUsed = m_budgetUsed;
+  stats.budgetTotal = (uint64_t)g_advancedSettings.m_imageDecodeBudget * 1024 * 1024;
+  stats.fetch = m_stageTimes[STAGE_FETCH];
+  stats.decode = m_stageTimes[STAGE_DECODE];
+  stats.store = m_stageTimes[STAGE_STORE];
+  return stats;
+}
+
 void CTextureCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
   if (strcmp(job->GetType(), kJobTypeCacheImage) == 0)
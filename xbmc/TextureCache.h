@@ -25,10 +25,92 @@
 #include "utils/JobManager.h"
 #include "TextureDatabase.h"
 #include "threads/Event.h"
+#include "threads/Condition.h"
 
 class CURL;
 class CBaseTexture;
 
+/*!
+ \ingroup textures
+ \brief Timing information for a single stage of the texture caching pipeline
+ */
+class CTextureStageTiming
+{
+public:
+  CTextureStageTiming() : count(0), totalMs(0), maxMs(0) {};
+  void Add(unsigned int ms)
+  {
+    count++;
+    totalMs += ms;
+    if (ms > maxMs)
+      maxMs = ms;
+  };
+  unsigned int Average() const { return count ? (unsigned int)(totalMs / count) : 0; };
+
+  unsigned int count;
+  uint64_t     totalMs;
+  unsigned int maxMs;
+};
+
+/*!
+ \ingroup textures
+ \brief Snapshot of the texture caching pipeline state
+ \sa CTextureCache::GetStats
+ */
+class CTextureCacheStats
+{
+public:
+  CTextureCacheStats() : queued(0), processing(0), decoding(0), waitingVisible(0), waitingPrefetch(0), budgetUsed(0), budgetTotal(0) {};
+
+  unsigned int queued;          ///< jobs waiting in the cache queue
+  unsigned int processing;      ///< jobs from the cache queue currently running
+  unsigned int decoding;        ///< decodes currently holding part of the decode budget
+  unsigned int waitingVisible;  ///< visible image decodes waiting on the decode budget
+  unsigned int waitingPrefetch; ///< background (prefetch) decodes waiting on the decode budget
+  uint64_t     budgetUsed;      ///< bytes of the decode budget in use
+  uint64_t     budgetTotal;     ///< total size of the decode budget in bytes
+  CTextureStageTiming fetch;    ///< reading the image bytes through the VFS
+  CTextureStageTiming decode;   ///< decoding (and scaling) the image into pixels
+  CTextureStageTiming store;    ///< encoding and writing the cached image
+};
+
+/*!
+ \ingroup textures
+ \brief Scoped reservation against the decode memory budget of the texture cache.
+
+ Decoding an image may take many times the size of the compressed file, so the texture cache
+ limits the (estimated) decoded size of all images being decoded at once. Visible images, ie those
+ that the GUI is waiting on, are given precedence over background (prefetch) decodes.
+ The reservation is held until this object is destroyed.
+
+ \sa CTextureCache::AcquireDecodeBudget
+ */
+class CTextureDecodeBudget
+{
+public:
+  CTextureDecodeBudget(bool visible);
+  ~CTextureDecodeBudget();
+
+  /*! \brief Reserve the given number of bytes, blocking until they're available
+   \param bytes estimated number of bytes the decode will need.
+   */
+  void Acquire(uint64_t bytes);
+
+  /*! \brief Update the reservation once the real size is known (eg after decoding)
+   \param bytes actual number of bytes in use.
+   */
+  void Update(uint64_t bytes);
+
+  bool IsVisible() const { return m_visible; };
+private:
+  CTextureDecodeBudget(const CTextureDecodeBudget&);
+  CTextureDecodeBudget const& operator=(CTextureDecodeBudget const&);
+
+  bool     m_visible;
+  bool     m_acquired;
+  uint64_t m_bytes;
+};
+
 /*!
  \ingroup textures
  \brief Texture cache class for handling the caching of images.
@@ -156,7 +238,46 @@ public:
    */
   bool Export(const CStdString &image, const CStdString &destination, bool overwrite);
   bool Export(const CStdString &image, const CStdString &destination); // TODO: BACKWARD COMPATIBILITY FOR MUSIC THUMBS
+
+  /*! \brief Stages of the texture caching pipeline
+   \sa RecordStageTime, GetStats
+   */
+  enum STAGE
+  {
+    STAGE_FETCH = 0,
+    STAGE_DECODE,
+    STAGE_STORE
+  };
+
+  /*! \brief Record the time taken by a stage of the caching pipeline
+   \param stage the stage that was timed.
+   \param ms time taken in milliseconds.
+   */
+  void RecordStageTime(STAGE stage, unsigned int ms);
+
+  /*! \brief Retrieve a snapshot of the caching pipeline: queue depths, decode budget usage and per-stage latency
+   \return the current statistics.
+   */
+  CTextureCacheStats GetStats() const;
+
 private:
+  friend class CTextureDecodeBudget;
+
+  /*! \brief Reserve bytes from the decode budget, blocking until they are available
+   Visible decodes only wait on the budget, background decodes additionally wait while any visible decode is waiting.
+   A decode is always allowed through when no other decode holds budget, so that a single oversized image cannot stall.
+   \param bytes number of bytes to reserve.
+   \param visible whether the GUI is waiting on this image.
+   \sa ReleaseDecodeBudget, CTextureDecodeBudget
+   */
+  void AcquireDecodeBudget(uint64_t bytes, bool visible);
+
+  /*! \brief Return bytes to the decode budget and wake any waiting decodes
+   \param bytes number of bytes to release.
+   \sa AcquireDecodeBudget
+   */
+  void ReleaseDecodeBudget(uint64_t bytes);
+
   // private construction, and no assignements; use the provided singleton methods
   CTextureCache();
   CTextureCache(const CTextureCache&);
@@ -227,5 +348,13 @@ private:
   CEvent               m_completeEvent; ///< Set whenever a job has finished
   std::vector<CTextureDetails> m_useCounts; ///< Use count tracking
   CCriticalSection             m_useCountSection;
+
+  mutable CCriticalSection       m_budgetSection;
+  XbmcThreads::ConditionVariable m_budgetCond;
+  uint64_t                       m_budgetUsed;      ///< bytes currently reserved by decodes
+  unsigned int                   m_decoding;        ///< number of decodes holding budget
+  unsigned int                   m_waitingVisible;  ///< visible decodes waiting on budget
+  unsigned int                   m_waitingPrefetch; ///< background decodes waiting on budget
+  CTextureStageTiming            m_stageTimes[STAGE_STORE+1];
 };
 
@@ -29,6 +29,8 @@
 #include "pictures/Picture.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
+#include "utils/Mime.h"
+#include "threads/SystemClock.h"
 #include "URL.h"
 #include "FileItem.h"
 #include "music/MusicThumbLoader.h"
@@ -41,6 +43,7 @@ CTextureCacheJob::CTextureCacheJob(const CStdString &url, const CStdString &oldH
 {
   m_url = url;
   m_oldHash = oldHash;
+  m_createdDDS = false;
   m_cachePath = CTextureCache::GetCacheFile(m_url);
 }
 
@@ -102,7 +105,10 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
     return true;
   }
 #endif
-  CBaseTexture *texture = LoadImage(image, width, height, additional_info, true);
+  // a caller wanting the texture back is the GUI waiting on a visible image, so it gets
+  // precedence on the decode budget over background caching.
+  CTextureDecodeBudget budget(out_texture != NULL);
+  CBaseTexture *texture = LoadImage(image, width, height, additional_info, true, &budget);
   if (texture)
   {
     if (texture->HasAlpha())
@@ -112,8 +118,16 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
 
     CLog::Log(LOGDEBUG, "%s image '%s' to '%s':", m_oldHash.empty() ? "Caching" : "Recaching", image.c_str(), m_details.file.c_str());
 
-    if (CPicture::CacheTexture(texture, width, height, CTextureCache::GetCachedPath(m_details.file)))
+    // background jobs compress the surface we already have in memory rather than having a
+    // CTextureDDSJob decode the cached image all over again.
+    bool createDDS = g_advancedSettings.m_useDDSFanart && !out_texture;
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    bool cached = CPicture::CacheTexture(texture, width, height, CTextureCache::GetCachedPath(m_details.file), &createDDS);
+    CTextureCache::Get().RecordStageTime(CTextureCache::STAGE_STORE, XbmcThreads::SystemClockMillis() - start);
+    if (cached)
     {
+      m_createdDDS = createDDS; // only set if the .dds was actually written, so a failure is retried
       m_details.width = width;
       m_details.height = height;
       if (out_texture) // caller wants the texture
@@ -154,13 +168,20 @@ CStdString CTextureCacheJob::DecodeImageURL(const CStdString &url, unsigned int
   return image;
 }
 
-CBaseTexture *CTextureCacheJob::LoadImage(const CStdString &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels)
+CBaseTexture *CTextureCacheJob::LoadImage(const CStdString &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels, CTextureDecodeBudget *budget)
 {
+  CTextureDecodeBudget backgroundBudget(false);
+  if (!budget)
+    budget = &backgroundBudget;
+
   if (additional_info == "music")
   { // special case for embedded music images
     MUSIC_INFO::EmbeddedArt art;
-    if (CMusicThumbLoader::GetEmbeddedThumb(image, art))
-      return CBaseTexture::LoadFromFileInMemory(&art.data[0], art.size, art.mime, width, height);
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    bool found = CMusicThumbLoader::GetEmbeddedThumb(image, art);
+    CTextureCache::Get().RecordStageTime(CTextureCache::STAGE_FETCH, XbmcThreads::SystemClockMillis() - start);
+    if (found)
+      return DecodeImage(&art.data[0], art.size, art.mime, width, height, false, *budget);
   }
 
   // Validate file URL to see if it is an image
@@ -170,7 +191,32 @@ CBaseTexture *CTextureCacheJob::LoadImage(const CStdString &image, unsigned int
       && !StringUtils::StartsWithNoCase(file.GetMimeType(), "image/") && !StringUtils::EqualsNoCase(file.GetMimeType(), "application/octet-stream")) // ignore non-pictures
     return NULL;
 
-  CBaseTexture *texture = CBaseTexture::LoadFromFile(image, width, height, CSettings::Get().GetBool("pictures.useexifrotation"), requirePixels, file.GetMimeType());
+  CBaseTexture *texture = NULL;
+  if (URIUtils::HasExtension(image, ".dds") || URIUtils::IsProtocol(image, "androidapp"))
+  { // dds images are already decoded, and android app icons are read as raw pixels
+    // by CBaseTexture::LoadFromFile, so there's no point splitting either into stages
+    budget->Acquire(EstimateDecodeSize(width, height));
+    texture = CBaseTexture::LoadFromFile(image, width, height, CSettings::Get().GetBool("pictures.useexifrotation"), requirePixels, file.GetMimeType());
+  }
+  else
+  {
+    // fetch the image bytes through the VFS prior to reserving any decode budget
+    XFILE::CFile imageFile;
+    XFILE::auto_buffer buf;
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    ssize_t size = imageFile.LoadFile(image, buf);
+    CTextureCache::Get().RecordStageTime(CTextureCache::STAGE_FETCH, XbmcThreads::SystemClockMillis() - start);
+    if (size <= 0)
+      return NULL;
+
+    std::string mimeType = file.GetMimeType();
+    if (mimeType.empty())
+    {
+      CURL url(image);
+      mimeType = url.GetFileType().empty() ? CMime::GetMimeType(url) : "image/" + url.GetFileType();
+    }
+    texture = DecodeImage((unsigned char *)buf.get(), buf.size(), mimeType, width, height, CSettings::Get().GetBool("pictures.useexifrotation"), *budget);
+  }
   if (!texture)
     return NULL;
 
@@ -183,6 +229,30 @@ CBaseTexture *CTextureCacheJob::LoadImage(const CStdString &image, unsigned int
   return texture;
 }
 
+CBaseTexture *CTextureCacheJob::DecodeImage(unsigned char *buffer, size_t size, const std::string &mimeType, unsigned int width, unsigned int height, bool autoRotate, CTextureDecodeBudget &budget)
+{
+  budget.Acquire(EstimateDecodeSize(width, height));
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  CBaseTexture *texture = CBaseTexture::LoadFromFileInMemory(buffer, size, mimeType, width, height, autoRotate);
+  CTextureCache::Get().RecordStageTime(CTextureCache::STAGE_DECODE, XbmcThreads::SystemClockMillis() - start);
+
+  // now we know what the decode actually cost, account for it
+  if (texture)
+    budget.Update((uint64_t)texture->GetPitch() * texture->GetRows());
+  return texture;
+}
+
+uint64_t CTextureCacheJob::EstimateDecodeSize(unsigned int width, unsigned int height)
+{
+  if (!width || !height)
+  {
+    height = g_advancedSettings.m_fanartRes;
+    width = height * 16 / 9;
+  }
+  return (uint64_t)width * height * 4;
+}
+
 bool CTextureCacheJob::UpdateableURL(const CStdString &url) const
 {
   // we don't constantly check online images
@@ -24,6 +24,7 @@
 #include "utils/Job.h"
 
 class CBaseTexture;
+class CTextureDecodeBudget;
 
 /*!
  \ingroup textures
@@ -78,6 +79,7 @@ public:
   CStdString m_url;
   CStdString m_oldHash;
   CTextureDetails m_details;
+  bool m_createdDDS; ///< whether a .dds version was written alongside the cached image
 private:
   friend class CEdenVideoArtUpdater;
 
@@ -111,13 +113,37 @@ private:
    Doesn't necessarily load the image at the desired size - the loader *may* decide to load it slightly larger
    or smaller than the desired size for speed reasons.
 
+   Loading is split into a fetch stage, where the file is read through the VFS, and a decode stage which
+   is only entered once the decode budget allows it.
+
    \param image the URL of the image file.
    \param width the desired maximum width.
    \param height the desired maximum height.
    \param additional_info extra info for loading, such as whether to flip horizontally.
+   \param budget the decode budget reservation to use. If NULL, a background reservation is used for the duration of the load.
+   \return a pointer to a CBaseTexture object, NULL if failed.
+   */
+  static CBaseTexture *LoadImage(const CStdString &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels = false, CTextureDecodeBudget *budget = NULL);
+
+  /*! \brief Decode an image held in memory, reserving from the decode budget first.
+   \param buffer the memory buffer holding the file.
+   \param size the size of buffer.
+   \param mimeType the mime type of the file in buffer.
+   \param width the desired maximum width.
+   \param height the desired maximum height.
+   \param autoRotate whether to rotate based on EXIF information.
+   \param budget the decode budget reservation to use.
    \return a pointer to a CBaseTexture object, NULL if failed.
    */
-  static CBaseTexture *LoadImage(const CStdString &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels = false);
+  static CBaseTexture *DecodeImage(unsigned char *buffer, size_t size, const std::string &mimeType, unsigned int width, unsigned int height, bool autoRotate, CTextureDecodeBudget &budget);
+
+  /*! \brief Estimate the memory a decode at the given target size will take
+   Images without a target size are assumed to be decoded at the fanart resolution.
+   \param width the desired maximum width, 0 if unknown.
+   \param height the desired maximum height, 0 if unknown.
+   \return estimated number of bytes for the decoded image.
+   */
+  static uint64_t EstimateDecodeSize(unsigned int width, unsigned int height);
 
   CStdString    m_cachePath;
 };
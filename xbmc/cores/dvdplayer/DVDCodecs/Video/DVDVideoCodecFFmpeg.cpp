@@ -750,6 +750,16 @@ int CDVDVideoCodecFFmpeg::FilterOpen(const std::string& filters, bool scale)
     return -1;
   }
 
+  // software deinterlacing (yadif) is the only option on renderers without shader
+  // deinterlacers, so slice the filters across cores. This must be set before any
+  // filter is added to the graph.
+  int num_threads = g_advancedSettings.m_videoFilterThreads;
+  if (num_threads <= 0)
+    num_threads = std::min(8 /*MAX_THREADS*/, g_cpuInfo.getCPUCount());
+  m_pFilterGraph->nb_threads  = num_threads;
+  m_pFilterGraph->thread_type = AVFILTER_THREAD_SLICE;
+  CLog::Log(LOGDEBUG, "CDVDVideoCodecFFmpeg::FilterOpen - using %d threads for filters '%s'", num_threads, filters.c_str());
+
   AVFilter* srcFilter = avfilter_get_by_name("buffer");
   AVFilter* outFilter = avfilter_get_by_name("buffersink"); // should be last filter in the graph for now
 
@@ -21,7 +21,6 @@
 #include "DVDMessageQueue.h"
 #include "DVDDemuxers/DVDDemuxUtils.h"
 #include "utils/log.h"
-#include "threads/SingleLock.h"
 #include "DVDClock.h"
 #include "utils/MathUtils.h"
 
@@ -59,8 +58,12 @@ void CDVDMessageQueue::Init()
 
 void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
-  CSingleLock lock(m_section);
+  CFastLock lock(m_section);
+  FlushLocked(type);
+}
 
+void CDVDMessageQueue::FlushLocked(CDVDMsg::Message type)
+{
   for(SList::iterator it = m_list.begin(); it != m_list.end();)
   {
     if (it->message->IsType(type) ||  type == CDVDMsg::NONE)
@@ -80,7 +83,7 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 
 void CDVDMessageQueue::Abort()
 {
-  CSingleLock lock(m_section);
+  CFastLock lock(m_section);
 
   m_bAbortRequest = true;
 
@@ -89,9 +92,9 @@ void CDVDMessageQueue::Abort()
 
 void CDVDMessageQueue::End()
 {
-  CSingleLock lock(m_section);
+  CFastLock lock(m_section);
 
-  Flush(CDVDMsg::NONE);
+  FlushLocked(CDVDMsg::NONE);
 
   m_bInitialized  = false;
   m_iDataSize     = 0;
@@ -101,7 +104,7 @@ void CDVDMessageQueue::End()
 
 MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
 {
-  CSingleLock lock(m_section);
+  CFastLock lock(m_section);
 
   if (!m_bInitialized)
   {
@@ -148,7 +151,7 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
 
 MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
 {
-  CSingleLock lock(m_section);
+  CFastLock lock(m_section);
 
   *pMsg = NULL;
 
@@ -223,7 +226,7 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
 unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
 {
-  CSingleLock lock(m_section);
+  CFastLock lock(m_section);
 
   if (!m_bInitialized)
     return 0;
@@ -249,7 +252,7 @@ void CDVDMessageQueue::WaitUntilEmpty()
 
 int CDVDMessageQueue::GetLevel() const
 {
-  CSingleLock lock(m_section);
+  CFastLock lock(m_section);
 
   if(m_iDataSize > m_iMaxDataSize)
     return 100;
@@ -264,7 +267,7 @@ int CDVDMessageQueue::GetLevel() const
 
 int CDVDMessageQueue::GetTimeSize() const
 {
-  CSingleLock lock(m_section);
+  CFastLock lock(m_section);
 
   if(IsDataBased())
     return 0;
@@ -23,8 +23,8 @@
 #include "DVDMessage.h"
 #include <string>
 #include <list>
-#include "threads/CriticalSection.h"
-#include "threads/Event.h"
+#include "threads/FastEvent.h"
+#include "threads/FastSection.h"
 
 struct DVDMessageListItem
 {
@@ -123,9 +123,11 @@ public:
   bool IsDataBased() const;
 
 private:
+  void FlushLocked(CDVDMsg::Message message);
 
-  CEvent m_hEvent;
-  mutable CCriticalSection m_section;
+  // every packet passes through here, so the lock is only held briefly and never recursively
+  CFastEvent m_hEvent;
+  mutable CFastSection m_section;
 
   bool m_bAbortRequest;
   bool m_bInitialized;
@@ -0,0 +1,174 @@
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "threads/test/TestHelpers.h"
+#include "utils/Stopwatch.h"
+
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class MessageProducer : public IRunnable
+{
+public:
+  MessageProducer(CDVDMessageQueue &queue, int messages) : m_queue(queue), m_messages(messages) {}
+  void Run()
+  {
+    for (int i = 0; i < m_messages; i++)
+      m_queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  }
+private:
+  CDVDMessageQueue &m_queue;
+  int m_messages;
+};
+
+class MessageWaiter : public IRunnable
+{
+public:
+  MessageWaiter(CDVDMessageQueue &queue) : m_queue(queue), m_result(MSGQ_OK) {}
+  void Run()
+  {
+    CDVDMsg *msg;
+    m_result = m_queue.Get(&msg, 10000);
+    if (msg)
+      msg->Release();
+  }
+  MsgQueueReturnCode GetResult() const { return m_result; }
+private:
+  CDVDMessageQueue &m_queue;
+  MsgQueueReturnCode m_result;
+};
+
+// the player's threads each take their messages, while the demuxer fills the queue
+// and the main thread keeps polling its level
+static float TimeQueue(int producers, int messages)
+{
+  CDVDMessageQueue queue("benchmark");
+  queue.Init();
+  queue.SetMaxDataSize(1024 * 1024);
+
+  MessageProducer producer(queue, messages);
+  std::vector<thread> threads;
+  CStopWatch watch;
+  watch.StartZero();
+  for (int i = 0; i < producers; i++)
+    threads.push_back(thread(producer));
+
+  int received = 0;
+  while (received < producers * messages)
+  {
+    CDVDMsg *msg;
+    if (queue.Get(&msg, 1000) != MSGQ_OK)
+      break;
+    msg->Release();
+    received++;
+    queue.GetLevel();
+  }
+  for (int i = 0; i < producers; i++)
+    threads[i].join();
+  EXPECT_EQ(producers * messages, received);
+
+  queue.End();
+  return watch.GetElapsedMilliseconds();
+}
+
+TEST(TestDVDMessageQueue, Priority)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 1);
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESET));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_EOF), 1);
+
+  // higher priority messages come first, and each priority in the order it was put
+  static const CDVDMsg::Message expected[] = { CDVDMsg::GENERAL_FLUSH, CDVDMsg::GENERAL_EOF,
+                                               CDVDMsg::GENERAL_RESYNC, CDVDMsg::GENERAL_RESET };
+  for (unsigned int i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+  {
+    CDVDMsg *msg;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+    EXPECT_EQ(expected[i], msg->GetMessageType());
+    msg->Release();
+  }
+
+  CDVDMsg *msg;
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 10));
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Flush)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  EXPECT_EQ(2u, queue.GetPacketCount(CDVDMsg::GENERAL_RESYNC));
+
+  queue.Flush(CDVDMsg::GENERAL_RESYNC);
+  EXPECT_EQ(0u, queue.GetPacketCount(CDVDMsg::GENERAL_RESYNC));
+  EXPECT_EQ(1u, queue.GetPacketCount(CDVDMsg::GENERAL_FLUSH));
+
+  // ending the queue flushes everything while holding the lock
+  queue.End();
+  EXPECT_FALSE(queue.IsInited());
+  EXPECT_EQ(0u, queue.GetPacketCount(CDVDMsg::GENERAL_FLUSH));
+}
+
+TEST(TestDVDMessageQueue, Wake)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  // a waiting Get() returns once a message is put
+  MessageWaiter waiter(queue);
+  thread waiting(waiter);
+  SleepMillis(50);
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  EXPECT_TRUE(waiting.timed_join(10000));
+  EXPECT_EQ(MSGQ_OK, waiter.GetResult());
+
+  // and when the queue is aborted
+  MessageWaiter aborted(queue);
+  thread abortedThread(aborted);
+  SleepMillis(50);
+  queue.Abort();
+  EXPECT_TRUE(abortedThread.timed_join(10000));
+  EXPECT_EQ(MSGQ_ABORT, aborted.GetResult());
+
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Producers)
+{
+  TimeQueue(4, 10000);
+}
+
+TEST(TestDVDMessageQueue, DISABLED_Benchmark_Throughput)
+{
+  const int messages = 1000000;
+  for (int producers = 1; producers <= 4; producers *= 2)
+    std::cout << producers << " producers: " << TimeQueue(producers, messages / producers) << "ms" << std::endl;
+}
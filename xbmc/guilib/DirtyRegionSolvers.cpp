@@ -81,3 +81,100 @@ void CGreedyDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegion
       output.push_back(currentRegion);
   }
 }
+
+CMergingDirtyRegionSolver::CMergingDirtyRegionSolver(float costPerPass, float costPerArea)
+{
+  m_costPerPass = costPerPass;
+  m_costPerArea = costPerArea;
+}
+
+float CMergingDirtyRegionSolver::Cost(const CRect &region) const
+{
+  return m_costPerPass + m_costPerArea * region.Area();
+}
+
+float CMergingDirtyRegionSolver::Saving(const CRect &a, const CRect &b) const
+{
+  CRect merged(a);
+  merged.Union(b);
+  return Cost(a) + Cost(b) - Cost(merged);
+}
+
+/* find the remaining region which saves the most when merged with region i, -1 if there is none */
+static int FindBestPartner(const std::vector<float> &savings, const std::vector<bool> &merged, unsigned int count, unsigned int i)
+{
+  int best = -1;
+  for (unsigned int j = 0; j < count; j++)
+  {
+    if (j != i && !merged[j] && (best < 0 || savings[i * count + j] > savings[i * count + best]))
+      best = j;
+  }
+  return best;
+}
+
+void CMergingDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
+{
+  CDirtyRegionList regions;
+  regions.reserve(input.size());
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    if (!input[i].IsEmpty())
+      regions.push_back(input[i]);
+  }
+
+  // agglomerative merge: each round joins the pair that saves the most. The saving of every
+  // pair is computed once, after which a merge only changes the pairs involving the merged
+  // region, so a round updates one row of savings and the best partner of the affected regions
+  // rather than checking every pair again.
+  const unsigned int count = regions.size();
+  std::vector<float> savings(count * count);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    for (unsigned int j = i + 1; j < count; j++)
+      savings[i * count + j] = savings[j * count + i] = Saving(regions[i], regions[j]);
+  }
+
+  std::vector<bool> merged(count, false);
+  std::vector<int> partner(count);
+  for (unsigned int i = 0; i < count; i++)
+    partner[i] = FindBestPartner(savings, merged, count, i);
+
+  while (true)
+  {
+    int bestI = -1;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      if (!merged[i] && partner[i] >= 0 &&
+          (bestI < 0 || savings[i * count + partner[i]] > savings[bestI * count + partner[bestI]]))
+        bestI = i;
+    }
+
+    if (bestI < 0 || savings[bestI * count + partner[bestI]] < 0.0f)
+      break; // every remaining pair is cheaper to render separately
+
+    const int bestJ = partner[bestI];
+    regions[bestI].Union(regions[bestJ]);
+    merged[bestJ] = true;
+
+    for (unsigned int k = 0; k < count; k++)
+    {
+      if (!merged[k] && (int)k != bestI)
+        savings[bestI * count + k] = savings[k * count + bestI] = Saving(regions[bestI], regions[k]);
+    }
+    for (unsigned int k = 0; k < count; k++)
+    {
+      if (merged[k])
+        continue;
+      if ((int)k == bestI || partner[k] == bestI || partner[k] == bestJ)
+        partner[k] = FindBestPartner(savings, merged, count, k);
+      else if (partner[k] < 0 || savings[k * count + bestI] > savings[k * count + partner[k]])
+        partner[k] = bestI;
+    }
+  }
+
+  for (unsigned int i = 0; i < count; i++)
+  {
+    if (!merged[i])
+      output.push_back(regions[i]);
+  }
+}
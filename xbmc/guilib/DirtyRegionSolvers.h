@@ -48,3 +48,22 @@ private:
   float m_costNewRegion;
   float m_costPerArea;
 };
+
+/*! \brief Solver which clusters regions by the cost of rendering them
+ Each rendering pass is charged a fixed overhead plus a cost per pixel drawn (overlapping
+ regions draw their overlap twice). Starting from the input regions, the pair whose union
+ saves the most is merged until no merge reduces the total cost, so nearby or overlapping
+ regions end up in one pass while regions far apart are still rendered separately.
+ */
+class CMergingDirtyRegionSolver : public IDirtyRegionSolver
+{
+public:
+  CMergingDirtyRegionSolver(float costPerPass, float costPerArea);
+  virtual void Solve(const CDirtyRegionList &input, CDirtyRegionList &output);
+private:
+  float Cost(const CRect &region) const;
+  float Saving(const CRect &a, const CRect &b) const;
+
+  float m_costPerPass;
+  float m_costPerArea;
+};
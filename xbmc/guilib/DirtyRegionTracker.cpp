@@ -48,6 +48,11 @@ void CDirtyRegionTracker::SelectAlgorithm()
       CLog::Log(LOGDEBUG, "guilib: Cost reduction as algorithm for solving rendering passes");
       m_solver = new CGreedyDirtyRegionSolver();
       break;
+    case DIRTYREGION_SOLVER_MERGE:
+      CLog::Log(LOGDEBUG, "guilib: Merging by cost (pass %.2f, pixel %.4f) for solving rendering passes",
+                g_advancedSettings.m_guiDirtyRegionPassCost, g_advancedSettings.m_guiDirtyRegionPixelCost);
+      m_solver = new CMergingDirtyRegionSolver(g_advancedSettings.m_guiDirtyRegionPassCost, g_advancedSettings.m_guiDirtyRegionPixelCost);
+      break;
     case DIRTYREGION_SOLVER_UNION:
       m_solver = new CUnionDirtyRegionSolver();
       CLog::Log(LOGDEBUG, "guilib: Union as algorithm for solving rendering passes");
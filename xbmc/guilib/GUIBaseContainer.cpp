@@ -63,6 +63,9 @@ CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, fl
   m_autoScrollDelayTime = 0;
   m_autoScrollIsReversed = false;
   m_lastRenderTime = 0;
+  m_keptStart = 0;
+  m_keptEnd = 0;
+  m_keptAny = false;
 }
 
 CGUIBaseContainer::~CGUIBaseContainer(void)
@@ -107,6 +110,12 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   // Free memory not used on screen
   if ((int)m_items.size() > m_itemsPerPage + cacheBefore + cacheAfter)
     FreeMemory(CorrectOffset(offset - cacheBefore, 0), CorrectOffset(offset + m_itemsPerPage + 1 + cacheAfter, 0));
+  else
+  { // everything is kept, and may be given a layout
+    m_keptStart = 0;
+    m_keptEnd = (int)m_items.size() - 1;
+    m_keptAny = true;
+  }
 
   CPoint origin = CPoint(m_posX, m_posY) + m_renderOffset;
   float pos = (m_orientation == VERTICAL) ? origin.y : origin.x;
@@ -834,6 +843,7 @@ void CGUIBaseContainer::UpdateLayout(bool updateAllItems)
   { // free memory of items
     for (iItems it = m_items.begin(); it != m_items.end(); ++it)
       (*it)->FreeMemory();
+    m_keptAny = false;
   }
   // and recalculate the layout
   CalculateLayout();
@@ -940,14 +950,18 @@ void CGUIBaseContainer::UpdateScrollByLetter()
 
   // for scrolling by letter we have an offset table into our vector.
   CStdString currentMatch;
+  std::wstring currentCharacter;
   for (unsigned int i = 0; i < m_items.size(); i++)
   {
-    CGUIListItemPtr item = m_items[i];
+    const CGUIListItemPtr &item = m_items[i];
     // The letter offset jumping is only for ASCII characters at present, and
     // our checks are all done in uppercase
-    CStdString nextLetter;
     std::wstring character = item->GetSortLabel().substr(0, 1);
     StringUtils::ToUpper(character);
+    if (i && character == currentCharacter)
+      continue; // sorted lists mostly repeat the letter, so skip the conversion
+    currentCharacter = character;
+    CStdString nextLetter;
     g_charsetConverter.wToUTF8(character, nextLetter);
     if (currentMatch != nextLetter)
     {
@@ -1063,7 +1077,12 @@ int CGUIBaseContainer::CorrectOffset(int offset, int cursor) const
 void CGUIBaseContainer::Reset()
 {
   m_wasReset = true;
+  // the items may come back in another order (or not at all), so we'd lose track of which of
+  // them have layouts - free them all
+  for (iItems it = m_items.begin(); it != m_items.end(); ++it)
+    (*it)->FreeMemory();
   m_items.clear();
+  m_keptAny = false;
   m_lastItem.reset();
   ResetAutoScrolling();
 }
@@ -1110,16 +1129,35 @@ void CGUIBaseContainer::SetRenderOffset(const CPoint &offset)
 
 void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
 {
-  if (keepStart < keepEnd)
-  { // remove before keepStart and after keepEnd
-    for (int i = 0; i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
-    for (int i = std::max(keepEnd + 1, 0); i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+  // only the items kept last time can have been given layouts since they were freed (by
+  // us or by another container showing the same items), so rather than running through
+  // all our items (of which there may be many thousands) we check just those
+  if (m_keptAny)
+  {
+    int last = (int)m_items.size() - 1;
+    if (m_keptStart <= m_keptEnd)
+      FreeMemory(std::max(m_keptStart, 0), std::min(m_keptEnd, last), keepStart, keepEnd);
+    else
+    { // wrapping
+      FreeMemory(0, std::min(m_keptEnd, last), keepStart, keepEnd);
+      FreeMemory(std::max(std::max(m_keptStart, m_keptEnd + 1), 0), last, keepStart, keepEnd);
+    }
   }
-  else
-  { // wrapping
-    for (int i = std::max(keepEnd + 1, 0); i < keepStart && i < (int)m_items.size(); ++i)
+  m_keptStart = keepStart;
+  m_keptEnd = keepEnd;
+  m_keptAny = true;
+}
+
+void CGUIBaseContainer::FreeMemory(int start, int end, int keepStart, int keepEnd)
+{
+  for (int i = start; i <= end; ++i)
+  {
+    bool keep;
+    if (keepStart <= keepEnd) // keep keepStart through keepEnd
+      keep = i >= keepStart && i <= keepEnd;
+    else // wrapping - keep everything except after keepEnd and before keepStart
+      keep = i <= keepEnd || i >= keepStart;
+    if (!keep)
       m_items[i]->FreeMemory();
   }
 }
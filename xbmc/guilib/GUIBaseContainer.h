@@ -128,6 +128,7 @@ protected:
   inline float Size() const;
   void MoveToRow(int row);
   void FreeMemory(int keepStart, int keepEnd);
+  void FreeMemory(int start, int end, int keepStart, int keepEnd);
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -219,6 +220,11 @@ private:
   CStdString m_match;
   float m_scrollItemsPerFrame;
 
+  // range of items kept by the last FreeMemory call, see FreeMemory
+  int m_keptStart;
+  int m_keptEnd;
+  bool m_keptAny;
+
   static const int letter_match_timeout = 1000;
 };
 
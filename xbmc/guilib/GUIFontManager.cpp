@@ -24,6 +24,7 @@
 #include "addons/Skin.h"
 #include "GUIFontTTF.h"
 #include "GUIFont.h"
+#include "GUITextLayout.h"
 #include "utils/XMLUtils.h"
 #include "GUIControlFactory.h"
 #include "filesystem/Directory.h"
@@ -47,7 +48,8 @@ GUIFontManager::GUIFontManager(void)
 
 GUIFontManager::~GUIFontManager(void)
 {
-  Clear();
+  // the layout cache may already be gone when we're destroyed at exit, so leave it be
+  FreeFonts();
 }
 
 void GUIFontManager::RescaleFontSizeAndAspect(float *size, float *aspect, const RESOLUTION_INFO &sourceRes, bool preserveAspect)
@@ -237,6 +239,8 @@ void GUIFontManager::ReloadTTFFonts(void)
 
     font->SetFont(pFontFile);
   }
+  // text laid out with the old font sizes is no longer valid
+  CGUITextLayout::ClearLayoutCache();
 }
 
 void GUIFontManager::Unload(const CStdString& strFontName)
@@ -245,6 +249,7 @@ void GUIFontManager::Unload(const CStdString& strFontName)
   {
     if ((*iFont)->GetFontName().Equals(strFontName))
     {
+      CGUITextLayout::ClearLayoutCache();
       delete (*iFont);
       m_vecFonts.erase(iFont);
       return;
@@ -325,6 +330,12 @@ CGUIFont* GUIFontManager::GetDefaultFont(bool border)
 }
 
 void GUIFontManager::Clear()
+{
+  CGUITextLayout::ClearLayoutCache();
+  FreeFonts();
+}
+
+void GUIFontManager::FreeFonts()
 {
   for (int i = 0; i < (int)m_vecFonts.size(); ++i)
   {
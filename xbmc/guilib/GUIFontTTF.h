@@ -27,6 +27,7 @@
  *
  */
 
+#include <deque>
 #include "utils/auto_buffer.h"
 
 // forward definition
@@ -113,6 +114,7 @@ protected:
   bool CacheCharacter(wchar_t letter, uint32_t style, Character *ch);
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX);
   void ClearCharacterCache();
+  void ClearCharacterIndex();
 
   virtual CBaseTexture* ReallocTexture(unsigned int& newHeight) = 0;
   virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
@@ -137,9 +139,8 @@ protected:
 
   color_t m_color;
 
-  Character *m_char;                 // our characters
-  Character *m_charquick[256*4];     // ascii chars (4 styles) here
-  int m_maxChars;                    // size of character array (can be incremented)
+  std::deque<Character> m_char;      // our characters (never move once cached)
+  Character **m_charIndex[256*4];    // pages of 256 characters, by style (4 styles) and high byte of the letter
   int m_numChars;                    // the current number of cached characters
 
   float m_ellipsesWidth;               // this is used every character (width of '.')
@@ -0,0 +1,198 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIFrameProfiler.h"
+#include "GraphicContext.h"
+#include "threads/SingleLock.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+#include <string.h>
+
+static const char *sectionNames[CGUIFrameProfiler::SECTION_COUNT] =
+{
+  "input", "process", "render", "texture", "present"
+};
+
+CGUIFrameProfiler::CGUIFrameProfiler()
+{
+  m_enabled = false;
+  m_frames.reserve(FRAME_HISTORY);
+  Reset();
+}
+
+CGUIFrameProfiler &CGUIFrameProfiler::Instance()
+{
+  static CGUIFrameProfiler profiler;
+  return profiler;
+}
+
+const char *CGUIFrameProfiler::GetSectionName(Section section)
+{
+  if (section < 0 || section >= SECTION_COUNT)
+    return "unknown";
+  return sectionNames[section];
+}
+
+void CGUIFrameProfiler::SetEnabled(bool enabled)
+{
+  CSingleLock lock(m_critSection);
+  if (enabled == m_enabled)
+    return;
+
+  // sections entered before the switch would be unbalanced, so we start over
+  Reset();
+  m_enabled = enabled;
+}
+
+void CGUIFrameProfiler::Reset()
+{
+  memset(&m_current, 0, sizeof(m_current));
+  memset(m_entered, 0, sizeof(m_entered));
+  memset(m_depth, 0, sizeof(m_depth));
+  m_frames.clear();
+  m_nextFrame = 0;
+  m_thread = 0;
+  m_hasThread = false;
+}
+
+void CGUIFrameProfiler::BeginSection(Section section)
+{
+  CSingleLock lock(m_critSection);
+  if (!m_enabled || !IsProfiledThread())
+    return;
+
+  if (m_depth[section]++ == 0)
+  {
+    m_entered[section] = CurrentHostCounter();
+    if (!m_current.sectionStart[section])
+      m_current.sectionStart[section] = m_entered[section];
+  }
+}
+
+void CGUIFrameProfiler::EndSection(Section section)
+{
+  CSingleLock lock(m_critSection);
+  if (!m_enabled || !IsProfiledThread() || !m_depth[section])
+    return;
+
+  if (--m_depth[section] == 0)
+    m_current.sectionTime[section] += CurrentHostCounter() - m_entered[section];
+}
+
+void CGUIFrameProfiler::EndFrame()
+{
+  if (!m_enabled)
+    return;
+
+  CSingleLock lock(m_critSection);
+  if (!m_enabled) // switched off meanwhile
+    return;
+  int64_t now = CurrentHostCounter();
+
+  if (!m_hasThread)
+  { // the first frame we see only tells us which thread renders
+    m_thread = CThread::GetCurrentThreadId();
+    m_hasThread = true;
+    m_current.start = now;
+    return;
+  }
+  if (!IsProfiledThread())
+    return;
+
+  m_current.end = now;
+  if (m_frames.size() < FRAME_HISTORY)
+    m_frames.push_back(m_current);
+  else
+    m_frames[m_nextFrame] = m_current;
+  m_nextFrame = (m_nextFrame + 1) % FRAME_HISTORY;
+
+  // sections still open (we're in the middle of them) continue in the next frame
+  memset(&m_current, 0, sizeof(m_current));
+  m_current.start = now;
+  for (unsigned int i = 0; i < SECTION_COUNT; i++)
+  {
+    if (m_depth[i])
+      m_current.sectionStart[i] = m_entered[i] = now;
+  }
+}
+
+void CGUIFrameProfiler::GetTrace(CVariant &trace) const
+{
+  std::vector<Frame> frames;
+  unsigned int oldest;
+  {
+    CSingleLock lock(m_critSection);
+    frames = m_frames;
+    oldest = frames.size() < FRAME_HISTORY ? 0 : m_nextFrame;
+  }
+
+  trace = CVariant(CVariant::VariantTypeObject);
+  trace["displayTimeUnit"] = "ms";
+  trace["traceEvents"] = CVariant(CVariant::VariantTypeArray);
+  if (frames.empty())
+    return;
+
+  // timestamps are in microseconds, relative to the oldest frame we have
+  const double usPerTick = 1000000.0 / CurrentHostFrequency();
+  const int64_t origin = frames[oldest].start;
+  float fps = g_graphicsContext.GetFPS();
+  const double frameBudget = 1000000.0 / (fps > 0.0f ? fps : 60.0f);
+
+  unsigned int missed = 0;
+  for (unsigned int n = 0; n < frames.size(); n++)
+  {
+    const Frame &frame = frames[(oldest + n) % frames.size()];
+    double duration = (frame.end - frame.start) * usPerTick;
+
+    CVariant event(CVariant::VariantTypeObject);
+    event["name"] = "frame";
+    event["cat"] = "frame";
+    event["ph"] = "X";
+    event["pid"] = 0;
+    event["tid"] = 0;
+    event["ts"] = (frame.start - origin) * usPerTick;
+    event["dur"] = duration;
+    event["args"]["missed"] = duration > frameBudget;
+    if (duration > frameBudget)
+      missed++;
+
+    for (unsigned int i = 0; i < SECTION_COUNT; i++)
+    {
+      if (!frame.sectionStart[i])
+        continue;
+      double sectionTime = frame.sectionTime[i] * usPerTick;
+      event["args"][sectionNames[i]] = sectionTime;
+
+      CVariant section(CVariant::VariantTypeObject);
+      section["name"] = sectionNames[i];
+      section["cat"] = "section";
+      section["ph"] = "X";
+      section["pid"] = 0;
+      section["tid"] = i + 1; // a row per section, as their summed times needn't nest inside the frame
+      section["ts"] = (frame.sectionStart[i] - origin) * usPerTick;
+      section["dur"] = sectionTime;
+      trace["traceEvents"].push_back(section);
+    }
+    trace["traceEvents"].push_back(event);
+  }
+  trace["otherData"]["frames"] = (unsigned int)frames.size();
+  trace["otherData"]["missedframes"] = missed;
+  trace["otherData"]["framebudget"] = frameBudget;
+}
@@ -0,0 +1,137 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GUILIB_GUIFRAMEPROFILER_H__
+#define GUILIB_GUIFRAMEPROFILER_H__
+#pragma once
+
+#include <vector>
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+class CVariant;
+
+/*!
+ \ingroup guilib
+ \brief Profiler keeping the timings of the last rendered frames
+
+ Each frame is split into coarse sections (input, process, render, texture uploads and present).
+ Sections may be entered any number of times within a frame and may nest; only the outermost entry
+ is timed, and the times of all entries in a frame are summed. Only the thread which ends frames
+ (the render thread) is profiled, calls from other threads are ignored. The last FRAME_HISTORY
+ frames are kept and may be exported as a Chrome trace.
+
+ The profiler is off unless enabled through advancedsettings.xml (<gui><frameprofiler>) or
+ JSON-RPC, and while off a section costs a single flag check.
+ */
+class CGUIFrameProfiler
+{
+public:
+  enum Section
+  {
+    SECTION_INPUT = 0,
+    SECTION_PROCESS,
+    SECTION_RENDER,
+    SECTION_TEXTURE,
+    SECTION_PRESENT,
+    SECTION_COUNT
+  };
+
+  static CGUIFrameProfiler &Instance();
+
+  /*! \brief Switch profiling on or off
+   Switching drops the recorded frames, and the profiled thread is picked again on the next frame.
+   */
+  void SetEnabled(bool enabled);
+  bool IsEnabled() const { return m_enabled; };
+
+  void BeginSection(Section section);
+  void EndSection(Section section);
+
+  /*! \brief Finish the current frame and start the next one
+   Must be called from the render thread once per frame, after the frame has been presented.
+   */
+  void EndFrame();
+
+  /*! \brief Export the recorded frames in the Chrome trace event format
+   Each frame is a complete ("X") event, and each section gets a row of its own. Frames
+   which took longer than the refresh interval of the display are flagged as missed.
+   \param trace [out] object holding the traceEvents array
+   */
+  void GetTrace(CVariant &trace) const;
+
+  static const char *GetSectionName(Section section);
+
+private:
+  CGUIFrameProfiler();
+  CGUIFrameProfiler(const CGUIFrameProfiler &);
+  CGUIFrameProfiler &operator=(const CGUIFrameProfiler &);
+
+  void Reset();
+  bool IsProfiledThread() const { return m_hasThread && CThread::IsCurrentThread(m_thread); };
+
+  static const unsigned int FRAME_HISTORY = 300;
+
+  struct Frame
+  {
+    int64_t start;
+    int64_t end;
+    int64_t sectionStart[SECTION_COUNT]; ///< \brief counter at the first entry of the section, 0 if not entered
+    int64_t sectionTime[SECTION_COUNT];  ///< \brief summed counter ticks spent in the section
+  };
+
+  volatile bool m_enabled; ///< \brief checked without locking so that sections are free while disabled
+
+  // the rest is guarded by m_critSection
+  Frame        m_current;
+  int64_t      m_entered[SECTION_COUNT];
+  unsigned int m_depth[SECTION_COUNT];
+
+  std::vector<Frame> m_frames; ///< \brief ring of the last FRAME_HISTORY frames
+  unsigned int       m_nextFrame;
+  ThreadIdentifier   m_thread;
+  bool               m_hasThread;
+  CCriticalSection   m_critSection;
+};
+
+/*! \brief Time the enclosing scope as the given section of the frame profiler
+ */
+class CGUIFrameProfilerScope
+{
+public:
+  CGUIFrameProfilerScope(CGUIFrameProfiler::Section section) : m_section(section)
+  {
+    m_active = CGUIFrameProfiler::Instance().IsEnabled();
+    if (m_active)
+      CGUIFrameProfiler::Instance().BeginSection(m_section);
+  };
+  ~CGUIFrameProfilerScope()
+  {
+    if (m_active)
+      CGUIFrameProfiler::Instance().EndSection(m_section);
+  };
+private:
+  CGUIFrameProfiler::Section m_section;
+  bool m_active;
+};
+
+#define GUIFRAMEPROFILER_SCOPE(section) CGUIFrameProfilerScope frameProfilerScope(CGUIFrameProfiler::section)
+
+#endif
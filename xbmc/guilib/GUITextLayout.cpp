@@ -22,11 +22,136 @@
 #include "GUIFont.h"
 #include "GUIControl.h"
 #include "GUIColorManager.h"
+#include "GraphicContext.h"
+#include "threads/SingleLock.h"
 #include "utils/CharsetConverter.h"
 #include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/log.h"
+
+#include <list>
+#include <map>
 
 using namespace std;
 
+#define LAYOUT_CACHE_SIZE     1024 // number of laid out texts kept for reuse
+#define LAYOUT_CACHE_MAX_TEXT 1024 // longer texts (plots etc.) aren't worth keeping
+
+/*! \brief Most recently used text layouts, shared by all CGUITextLayout's.
+ Items scrolling into view in lists mostly show text that has been laid out before
+ with the same font and width, so we keep the result of parsing, wrapping and bidi
+ flipping it around.
+ */
+class CTextLayoutCache
+{
+public:
+  struct Key
+  {
+    CStdStringW text;
+    CGUIFont   *font;
+    uint32_t    style;
+    color_t     color;
+    float       maxWidth;
+    float       maxHeight;
+    float       scaleX;
+    float       scaleY;
+    bool        forceLTRReadingOrder;
+
+    bool operator<(const Key &right) const
+    {
+      if (font != right.font) return font < right.font;
+      if (style != right.style) return style < right.style;
+      if (color != right.color) return color < right.color;
+      if (maxWidth != right.maxWidth) return maxWidth < right.maxWidth;
+      if (maxHeight != right.maxHeight) return maxHeight < right.maxHeight;
+      if (scaleX != right.scaleX) return scaleX < right.scaleX;
+      if (scaleY != right.scaleY) return scaleY < right.scaleY;
+      if (forceLTRReadingOrder != right.forceLTRReadingOrder) return right.forceLTRReadingOrder;
+      return text < right.text;
+    }
+  };
+
+  struct Layout
+  {
+    vecColors colors;
+    vector<CGUIString> lines;
+    float width;
+    float height;
+  };
+
+  CTextLayoutCache() : m_hits(0), m_misses(0), m_layoutTime(0) {}
+
+  bool Get(const Key &key, Layout &layout)
+  {
+    CSingleLock lock(m_section);
+    LayoutMap::iterator i = m_layouts.find(key);
+    if (i == m_layouts.end())
+    {
+      m_misses++;
+      return false;
+    }
+    // move to the front of our most recently used list
+    m_lru.splice(m_lru.begin(), m_lru, i->second.lru);
+    layout = i->second.layout;
+    m_hits++;
+    return true;
+  }
+
+  void Add(const Key &key, const Layout &layout, int64_t layoutTime)
+  {
+    CSingleLock lock(m_section);
+    m_layoutTime += layoutTime;
+    pair<LayoutMap::iterator, bool> added = m_layouts.insert(make_pair(key, Entry()));
+    if (!added.second)
+      return;
+    added.first->second.layout = layout;
+    m_lru.push_front(&added.first->first);
+    added.first->second.lru = m_lru.begin();
+    while (m_layouts.size() > LAYOUT_CACHE_SIZE)
+    {
+      m_layouts.erase(*m_lru.back());
+      m_lru.pop_back();
+    }
+  }
+
+  void Clear()
+  {
+    CSingleLock lock(m_section);
+    if (m_hits || m_misses)
+      CLog::Log(LOGDEBUG, "%s: %u hits, %u misses, %.1fms spent in layout", __FUNCTION__,
+                m_hits, m_misses, 1000.f * m_layoutTime / CurrentHostFrequency());
+    m_hits = m_misses = 0;
+    m_layoutTime = 0;
+    m_lru.clear();
+    m_layouts.clear();
+  }
+
+  void GetStats(unsigned int &hits, unsigned int &misses, float &layoutTime)
+  {
+    CSingleLock lock(m_section);
+    hits = m_hits;
+    misses = m_misses;
+    layoutTime = 1000.f * m_layoutTime / CurrentHostFrequency();
+  }
+
+private:
+  struct Entry
+  {
+    Layout layout;
+    list<const Key*>::iterator lru;
+  };
+  typedef map<Key, Entry> LayoutMap;
+
+  LayoutMap        m_layouts;
+  list<const Key*> m_lru;      ///< keys of m_layouts, most recently used first
+  unsigned int     m_hits;
+  unsigned int     m_misses;
+  int64_t          m_layoutTime;
+  CCriticalSection m_section;
+};
+
+static CTextLayoutCache g_textLayoutCache;
+
 CGUIString::CGUIString(iString start, iString end, bool carriageReturn)
 {
   m_text.assign(start, end);
@@ -240,6 +365,33 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
 
 void CGUITextLayout::UpdateCommon(const CStdStringW &text, float maxWidth, bool forceLTRReadingOrder)
 {
+  // check whether this text has been laid out before
+  bool cacheable = m_font && text.size() <= LAYOUT_CACHE_MAX_TEXT;
+  CTextLayoutCache::Key key;
+  if (cacheable)
+  {
+    key.text = text;
+    key.font = m_font;
+    key.style = m_font->GetStyle();
+    key.color = m_textColor;
+    key.maxWidth = m_wrap ? maxWidth : 0;
+    key.maxHeight = m_maxHeight;
+    key.scaleX = g_graphicsContext.GetGUIScaleX();
+    key.scaleY = g_graphicsContext.GetGUIScaleY();
+    key.forceLTRReadingOrder = forceLTRReadingOrder;
+
+    CTextLayoutCache::Layout layout;
+    if (g_textLayoutCache.Get(key, layout))
+    {
+      m_lines.swap(layout.lines);
+      m_colors.swap(layout.colors);
+      m_textWidth = layout.width;
+      m_textHeight = layout.height;
+      return;
+    }
+  }
+  int64_t start = CurrentHostCounter();
+
   // parse the text for style information
   vecText parsedText;
   vecColors colors;
@@ -247,6 +399,26 @@ void CGUITextLayout::UpdateCommon(const CStdStringW &text, float maxWidth, bool
 
   // and update
   UpdateStyled(parsedText, colors, maxWidth, forceLTRReadingOrder);
+
+  if (cacheable)
+  {
+    CTextLayoutCache::Layout layout;
+    layout.lines = m_lines;
+    layout.colors = m_colors;
+    layout.width = m_textWidth;
+    layout.height = m_textHeight;
+    g_textLayoutCache.Add(key, layout, CurrentHostCounter() - start);
+  }
+}
+
+void CGUITextLayout::ClearLayoutCache()
+{
+  g_textLayoutCache.Clear();
+}
+
+void CGUITextLayout::GetLayoutCacheStats(unsigned int &hits, unsigned int &misses, float &layoutTime)
+{
+  g_textLayoutCache.GetStats(hits, misses, layoutTime);
 }
 
 void CGUITextLayout::UpdateStyled(const vecText &text, const vecColors &colors, float maxWidth, bool forceLTRReadingOrder)
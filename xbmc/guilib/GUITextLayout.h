@@ -110,6 +110,18 @@ public:
   static void DrawText(CGUIFont *font, float x, float y, color_t color, color_t shadowColor, const CStdString &text, uint32_t align);
   static void Filter(CStdString &text);
 
+  /*! \brief Clear the text layouts kept for reuse, and reset their statistics.
+   Must be called whenever fonts are unloaded or their metrics change.
+   */
+  static void ClearLayoutCache();
+
+  /*! \brief Statistics of the text layouts kept for reuse since the cache was last cleared
+   \param hits [out] number of updates served from the cache
+   \param misses [out] number of updates that had to lay out their text
+   \param layoutTime [out] time (in ms) spent laying out text on misses
+   */
+  static void GetLayoutCacheStats(unsigned int &hits, unsigned int &misses, float &layoutTime);
+
 protected:
   void LineBreakText(const vecText &text, std::vector<CGUIString> &lines);
   void WrapText(const vecText &text, float maxWidth);
@@ -71,11 +71,13 @@ CGUIWindow::CGUIWindow(int id, const CStdString &xmlFile)
   m_exclusiveMouseControl = 0;
   m_clearBackground = 0xff000000; // opaque black -> always clear
   m_windowXMLRootElement = NULL;
+  m_windowXMLResolvedElement = NULL;
 }
 
 CGUIWindow::~CGUIWindow(void)
 {
   delete m_windowXMLRootElement;
+  delete m_windowXMLResolvedElement;
 }
 
 bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
@@ -135,6 +137,8 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
 bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPath)
 {
   // load window xml if we don't have it stored yet
+  if (!m_windowXMLRootElement)
+    m_windowXMLRootElement = g_windowManager.TakePreloadedXML(GetID(), strPath);
   if (!m_windowXMLRootElement)
   {
     CXBMCTinyXML xmlDoc;
@@ -165,16 +169,32 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
     return false;
   }
 
-  // we must create copy of root element as we will manipulate it when resolving includes
-  // and we don't want original root element to change
-  pRootElement = (TiXmlElement*)pRootElement->Clone();
-
   // set the scaling resolution so that any control creation or initialisation can
   // be done with respect to the correct aspect ratio
   g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
 
-  // Resolve any includes that may be present and save conditions used to do it
-  g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+  // resolving includes is costly, so for our stored xml we keep the resolved tree
+  // and reuse it for as long as the conditions used to resolve it keep their values
+  bool useCache = (pRootElement == m_windowXMLRootElement);
+  if (useCache && m_windowXMLResolvedElement && !g_infoManager.ConditionsChangedValues(m_xmlIncludeConditions))
+    pRootElement = (TiXmlElement*)m_windowXMLResolvedElement->Clone();
+  else
+  {
+    // we must create copy of root element as we will manipulate it when resolving includes
+    // and we don't want original root element to change
+    pRootElement = (TiXmlElement*)pRootElement->Clone();
+
+    // Resolve any includes that may be present and save conditions used to do it
+    if (useCache)
+      m_xmlIncludeConditions.clear();
+    g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+
+    if (useCache)
+    {
+      delete m_windowXMLResolvedElement;
+      m_windowXMLResolvedElement = (TiXmlElement*)pRootElement->Clone();
+    }
+  }
   // now load in the skin file
   SetDefaults();
 
@@ -768,6 +788,8 @@ void CGUIWindow::FreeResources(bool forceUnload /*= FALSE */)
   {
     delete m_windowXMLRootElement;
     m_windowXMLRootElement = NULL;
+    delete m_windowXMLResolvedElement;
+    m_windowXMLResolvedElement = NULL;
     m_xmlIncludeConditions.clear();
   }
 }
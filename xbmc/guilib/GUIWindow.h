@@ -150,6 +150,7 @@ public:
   const RESOLUTION_INFO &GetCoordsRes() const { return m_coordsRes; };
   void SetLoadType(LOAD_TYPE loadType) { m_loadType = loadType; };
   LOAD_TYPE GetLoadType() { return m_loadType; } const
+  bool HasStoredXML() const { return m_windowXMLRootElement != NULL; };
   int GetRenderOrder() { return m_renderOrder; };
   virtual void SetInitialVisibility();
   virtual bool IsVisible() const { return true; }; // windows are always considered visible as they implement their own
@@ -269,6 +270,7 @@ protected:
   CGUIAction m_unloadActions;
 
   TiXmlElement* m_windowXMLRootElement;
+  TiXmlElement* m_windowXMLResolvedElement; ///< \brief m_windowXMLRootElement with includes resolved, valid while the include conditions keep their values
 
   bool m_manualRunActions;
 
@@ -31,12 +31,58 @@
 #include "settings/Settings.h"
 #include "addons/Skin.h"
 #include "GUITexture.h"
+#include "GUIFrameProfiler.h"
 #include "windowing/WindowingFactory.h"
 #include "utils/Variant.h"
+#include "utils/JobManager.h"
+#include "utils/TimeUtils.h"
+#include "utils/XBMCTinyXML.h"
+#include "utils/StringUtils.h"
 #include "Key.h"
 
+#include <algorithm>
+#include <functional>
+
 using namespace std;
 
+/*! \brief Job reading and parsing the xml file of a window, see CGUIWindowManager::PreloadWindow
+ */
+class CWindowXMLPreloadJob : public CJob
+{
+public:
+  CWindowXMLPreloadJob(int windowID, const CStdString &path, const CStdString &lowerPath)
+    : m_windowID(windowID), m_path(path), m_lowerPath(lowerPath), m_root(NULL)
+  {
+  }
+  virtual ~CWindowXMLPreloadJob()
+  {
+    delete m_root;
+  }
+  virtual const char *GetType() const { return "windowpreload"; }
+  virtual bool DoWork()
+  {
+    CXBMCTinyXML xmlDoc;
+    std::string pathLower = m_path;
+    StringUtils::ToLower(pathLower);
+    if (!xmlDoc.LoadFile(m_path) && !xmlDoc.LoadFile(pathLower) && !xmlDoc.LoadFile(m_lowerPath))
+      return false; // the window reports the error when it loads
+    m_root = (TiXmlElement*)xmlDoc.RootElement()->Clone();
+    return true;
+  }
+  TiXmlElement *TakeRoot()
+  {
+    TiXmlElement *root = m_root;
+    m_root = NULL;
+    return root;
+  }
+
+  int        m_windowID;
+  CStdString m_path;
+  CStdString m_lowerPath;
+private:
+  TiXmlElement *m_root;
+};
+
 CGUIWindowManager::CGUIWindowManager(void)
 {
   m_pCallback = NULL;
@@ -47,6 +93,7 @@ CGUIWindowManager::CGUIWindowManager(void)
 
 CGUIWindowManager::~CGUIWindowManager(void)
 {
+  ClearPreloadedWindows();
 }
 
 void CGUIWindowManager::Initialize()
@@ -383,6 +430,7 @@ void CGUIWindowManager::ActivateWindow_Internal(int iWindowID, const vector<stri
 
   // debug
   CLog::Log(LOGDEBUG, "Activating window ID: %i", iWindowID);
+  int64_t start = CurrentHostCounter();
 
   if (!g_passwordManager.CheckMenuLock(iWindowID))
   {
@@ -435,6 +483,126 @@ void CGUIWindowManager::ActivateWindow_Internal(int iWindowID, const vector<stri
   msg.SetStringParams(params);
   pNewWindow->OnMessage(msg);
 //  g_infoManager.SetPreviousWindow(WINDOW_INVALID);
+
+  CLog::Log(LOGDEBUG, "Activated window ID: %i in %.2fms", iWindowID, 1000.f * (CurrentHostCounter() - start) / CurrentHostFrequency());
+
+  // learn where we go from here, and get the most likely next window ready
+  if (currentWindow != WINDOW_INVALID)
+    m_windowSuccessors[currentWindow][iWindowID]++;
+  PreloadLikelySuccessor(iWindowID);
+}
+
+void CGUIWindowManager::PreloadLikelySuccessor(int windowID)
+{
+  std::map<int, std::map<int, unsigned int> >::const_iterator successors = m_windowSuccessors.find(windowID);
+  if (successors == m_windowSuccessors.end())
+    return;
+
+  int likeliest = WINDOW_INVALID;
+  unsigned int count = 0;
+  for (std::map<int, unsigned int>::const_iterator i = successors->second.begin(); i != successors->second.end(); ++i)
+  {
+    if (i->second > count)
+    {
+      likeliest = i->first;
+      count = i->second;
+    }
+  }
+  if (likeliest != WINDOW_INVALID)
+    PreloadWindow(likeliest);
+}
+
+void CGUIWindowManager::PreloadLikelyWindows(unsigned int count)
+{
+  // how often each window was activated, from whichever window
+  std::map<int, unsigned int> activations;
+  for (std::map<int, std::map<int, unsigned int> >::const_iterator i = m_windowSuccessors.begin(); i != m_windowSuccessors.end(); ++i)
+  {
+    for (std::map<int, unsigned int>::const_iterator j = i->second.begin(); j != i->second.end(); ++j)
+      activations[j->first] += j->second;
+  }
+
+  std::vector< std::pair<unsigned int, int> > windows;
+  for (std::map<int, unsigned int>::const_iterator i = activations.begin(); i != activations.end(); ++i)
+  {
+    if (i->first != GetActiveWindow())
+      windows.push_back(std::make_pair(i->second, i->first));
+  }
+  std::sort(windows.begin(), windows.end(), std::greater< std::pair<unsigned int, int> >());
+
+  for (unsigned int i = 0; i < windows.size() && i < count; i++)
+    PreloadWindow(windows[i].second);
+}
+
+void CGUIWindowManager::PreloadWindow(int id)
+{
+  CGUIWindow *window = GetWindow(id);
+  if (!window || window->HasStoredXML() || !g_SkinInfo)
+    return;
+
+  CStdString xmlFile = window->GetProperty("xmlfile").asString();
+  if (xmlFile.empty())
+    return;
+
+  CStdString path, lowerPath;
+  if (xmlFile.find("\\") != std::string::npos || xmlFile.find("/") != std::string::npos)
+    path = xmlFile;
+  else
+  { // same lookup as CGUIWindow::Load(), though the resolution is left for the window to work out
+    RESOLUTION_INFO res;
+    std::string xmlFileLower = xmlFile;
+    StringUtils::ToLower(xmlFileLower);
+    lowerPath = g_SkinInfo->GetSkinPath(xmlFileLower, &res);
+    path = g_SkinInfo->GetSkinPath(xmlFile, &res);
+  }
+
+  CSingleLock lock(m_preloadSection);
+  std::map<int, std::pair<CStdString, TiXmlElement*> >::const_iterator i = m_preloadedXML.find(id);
+  if ((i != m_preloadedXML.end() && i->second.first == path) || m_preloadingWindows.find(id) != m_preloadingWindows.end())
+    return;
+  m_preloadingWindows.insert(id);
+  lock.Leave();
+
+  CLog::Log(LOGDEBUG, "%s - preloading %s for window %i", __FUNCTION__, path.c_str(), id);
+  CJobManager::GetInstance().AddJob(new CWindowXMLPreloadJob(id, path, lowerPath), this);
+}
+
+void CGUIWindowManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CWindowXMLPreloadJob *preload = (CWindowXMLPreloadJob *)job;
+  CSingleLock lock(m_preloadSection);
+  m_preloadingWindows.erase(preload->m_windowID);
+  if (!success)
+    return;
+
+  std::pair<CStdString, TiXmlElement*> &entry = m_preloadedXML[preload->m_windowID];
+  delete entry.second;
+  entry.first = preload->m_path;
+  entry.second = preload->TakeRoot();
+}
+
+TiXmlElement *CGUIWindowManager::TakePreloadedXML(int id, const CStdString &path)
+{
+  CSingleLock lock(m_preloadSection);
+  std::map<int, std::pair<CStdString, TiXmlElement*> >::iterator i = m_preloadedXML.find(id);
+  if (i == m_preloadedXML.end())
+    return NULL;
+
+  TiXmlElement *root = NULL;
+  if (i->second.first == path)
+    root = i->second.second;
+  else
+    delete i->second.second; // stale, eg from before a skin change
+  m_preloadedXML.erase(i);
+  return root;
+}
+
+void CGUIWindowManager::ClearPreloadedWindows()
+{
+  CSingleLock lock(m_preloadSection);
+  for (std::map<int, std::pair<CStdString, TiXmlElement*> >::iterator i = m_preloadedXML.begin(); i != m_preloadedXML.end(); ++i)
+    delete i->second.second;
+  m_preloadedXML.clear();
 }
 
 void CGUIWindowManager::CloseDialogs(bool forceClose) const
@@ -497,6 +665,7 @@ bool RenderOrderSortFunction(CGUIWindow *first, CGUIWindow *second)
 void CGUIWindowManager::Process(unsigned int currentTime)
 {
   assert(g_application.IsCurrentThread());
+  GUIFRAMEPROFILER_SCOPE(SECTION_PROCESS);
   CSingleLock lock(g_graphicsContext);
 
   CDirtyRegionList dirtyregions;
@@ -550,6 +719,7 @@ void CGUIWindowManager::RenderPass() const
 bool CGUIWindowManager::Render()
 {
   assert(g_application.IsCurrentThread());
+  GUIFRAMEPROFILER_SCOPE(SECTION_RENDER);
   CSingleLock lock(g_graphicsContext);
 
   CDirtyRegionList dirtyRegions = m_tracker.GetDirtyRegions();
@@ -709,6 +879,10 @@ void CGUIWindowManager::DeInitialize()
   m_vecCustomWindows.clear();
   m_activeDialogs.clear();
 
+  // the skin is going, and with it the xml we read for its windows. The successors
+  // are kept, as they are what we preload from once the next skin is loaded.
+  ClearPreloadedWindows();
+
   m_initialized = false;
 }
 
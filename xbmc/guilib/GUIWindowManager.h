@@ -33,10 +33,13 @@
 #include "IMsgTargetCallback.h"
 #include "DirtyRegionTracker.h"
 #include "utils/GlobalsHandling.h"
+#include "utils/Job.h"
 #include "guilib/WindowIDs.h"
 #include <list>
+#include <set>
 
 class CGUIDialog;
+class TiXmlElement;
 
 #define WINDOW_ID_MASK 0xffff
 
@@ -44,7 +47,7 @@ class CGUIDialog;
  \ingroup winman
  \brief
  */
-class CGUIWindowManager
+class CGUIWindowManager : public IJobCallback
 {
 public:
   CGUIWindowManager(void);
@@ -139,6 +142,35 @@ public:
   bool IsOverlayAllowed() const;
   void ShowOverlay(CGUIWindow::OVERLAY_STATE state);
   void GetActiveModelessWindows(std::vector<int> &ids);
+
+  /*! \brief Read and parse the xml file of a window on a background thread
+   Only the file is read and parsed in the background, includes are resolved and controls created
+   on the application thread when the window is loaded, as those depend on the info manager.
+   Does nothing if the window already has its xml stored.
+   It should only be called from the application thread.
+   \param id the id of the window to preload
+   \sa TakePreloadedXML
+   */
+  void PreloadWindow(int id);
+
+  /*! \brief Preload the windows activated most often so far
+   Windows keep their xml once loaded until the skin is unloaded, so this is meant to be called
+   right after a skin is (re)loaded, when none of its windows have their xml yet.
+   \param count the number of windows to preload
+   \sa PreloadWindow
+   */
+  void PreloadLikelyWindows(unsigned int count);
+
+  /*! \brief Take the xml preloaded for a window
+   \param id the id of the window
+   \param path the path of the xml file the window is about to load
+   \return the root element of the preloaded xml which the caller must delete, or NULL if no xml
+            was preloaded from the given path
+   \sa PreloadWindow
+   */
+  TiXmlElement *TakePreloadedXML(int id, const CStdString &path);
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
 #ifdef _DEBUG
   void DumpTextureUse();
 #endif
@@ -156,6 +188,9 @@ private:
   friend class CApplicationMessenger;
   void ActivateWindow_Internal(int windowID, const std::vector<std::string> &params, bool swappingWindows);
 
+  void PreloadLikelySuccessor(int windowID);
+  void ClearPreloadedWindows();
+
   typedef std::map<int, CGUIWindow *> WindowMap;
   WindowMap m_mapWindows;
   std::vector <CGUIWindow*> m_vecCustomWindows;
@@ -179,6 +214,11 @@ private:
 
   CDirtyRegionTracker m_tracker;
 
+  std::map<int, std::map<int, unsigned int> > m_windowSuccessors; ///< \brief how often each window was activated from a window
+  std::map<int, std::pair<CStdString, TiXmlElement*> > m_preloadedXML; ///< \brief path and root element of preloaded windows
+  std::set<int> m_preloadingWindows;
+  CCriticalSection m_preloadSection;
+
 private:
   class CGUIWindowManagerIdCache
   {
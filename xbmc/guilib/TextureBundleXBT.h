@@ -52,6 +52,7 @@ private:
 
   bool m_themeBundle;
   CXBTFReader m_XBTFReader;
+  std::vector<unsigned char> m_unpackBuffer; ///< scratch space for decompressing lzo packed frames
 };
 
 
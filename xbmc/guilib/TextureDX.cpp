@@ -21,6 +21,7 @@
 #include "TextureDX.h"
 #include "windowing/WindowingFactory.h"
 #include "utils/log.h"
+#include "GUIFrameProfiler.h"
 
 #ifdef HAS_DX
 
@@ -74,6 +75,7 @@ void CDXTexture::DestroyTextureObject()
 
 void CDXTexture::LoadToGPU()
 {
+  GUIFRAMEPROFILER_SCOPE(SECTION_TEXTURE);
   if (!m_pixels)
   {
     // nothing to load - probably same image (no change)
@@ -24,6 +24,7 @@
 #include "utils/log.h"
 #include "utils/GLUtils.h"
 #include "guilib/TextureManager.h"
+#include "guilib/GUIFrameProfiler.h"
 
 #if defined(HAS_GL) || defined(HAS_GLES)
 
@@ -56,6 +57,7 @@ void CGLTexture::DestroyTextureObject()
 
 void CGLTexture::LoadToGPU()
 {
+  GUIFRAMEPROFILER_SCOPE(SECTION_TEXTURE);
   if (!m_pixels)
   {
     // nothing to load - probably same image (no change)
@@ -30,7 +30,6 @@
 #ifdef _DEBUG_TEXTURES
 #include "utils/TimeUtils.h"
 #endif
-#include "threads/SystemClock.h"
 #include "filesystem/File.h"
 #include "filesystem/Directory.h"
 #include "URL.h"
@@ -216,6 +215,10 @@ void CTextureMap::Add(CBaseTexture* texture, int delay)
 /************************************************************************/
 CGUITextureManager::CGUITextureManager(void)
 {
+  m_unusedMemUsage = 0;
+  m_unusedBudget = 0;
+  m_hits = 0;
+  m_misses = 0;
   // we set the theme bundle to be the first bundle (thus prioritizing it)
   m_TexBundle[0].SetThemeBundle(true);
 }
@@ -252,14 +255,10 @@ bool CGUITextureManager::HasTexture(const CStdString &textureName, CStdString *p
 
   // Check our loaded and bundled textures - we store in bundles using \\.
   CStdString bundledName = CTextureBundle::Normalize(textureName);
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  if (m_textures.find(textureName) != m_textures.end())
   {
-    CTextureMap *pMap = m_vecTextures[i];
-    if (pMap->GetName() == textureName)
-    {
-      if (size) *size = 1;
-      return true;
-    }
+    if (size) *size = 1;
+    return true;
   }
 
   for (int i = 0; i < 2; i++)
@@ -289,33 +288,34 @@ const CTextureArray& CGUITextureManager::Load(const CStdString& strTextureName,
 
   if (size) // we found the texture
   {
-    for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+    iTextures i = m_textures.find(strTextureName);
+    if (i != m_textures.end())
     {
-      CTextureMap *pMap = m_vecTextures[i];
-      if (pMap->GetName() == strTextureName)
-      {
-        //CLog::Log(LOGDEBUG, "Total memusage %u", GetMemoryUsage());
-        return pMap->GetTexture();
-      }
+      //CLog::Log(LOGDEBUG, "Total memusage %u", GetMemoryUsage());
+      m_hits++;
+      return i->second->GetTexture();
     }
     // Whoops, not there.
     return emptyTexture;
   }
 
-  for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end(); ++i)
+  std::map<CStdString, ilistUnused>::iterator unused = m_unusedIndex.find(strTextureName);
+  if (unused != m_unusedIndex.end())
   {
-    CTextureMap* pMap = i->first;
-    if (pMap->GetName() == strTextureName && i->second > 0)
-    {
-      m_vecTextures.push_back(pMap);
-      m_unusedTextures.erase(i);
-      return pMap->GetTexture();
-    }
+    CTextureMap* pMap = unused->second->first;
+    m_unusedMemUsage -= pMap->GetMemoryUsage();
+    m_unusedTextures.erase(unused->second);
+    m_unusedIndex.erase(unused);
+    m_textures.insert(make_pair(strTextureName, pMap));
+    m_hits++;
+    return pMap->GetTexture();
   }
 
   if (checkBundleOnly && bundle == -1)
     return emptyTexture;
 
+  m_misses++;
+
   //Lock here, we will do stuff that could break rendering
   CSingleLock lock(g_graphicsContext);
 
@@ -387,7 +387,7 @@ const CTextureArray& CGUITextureManager::Load(const CStdString& strTextureName,
       } // of for (int iImage=0; iImage < iImages; iImage++)
     }
 
-    m_vecTextures.push_back(pMap);
+    m_textures.insert(make_pair(strTextureName, pMap));
     return pMap->GetTexture();
   } // of if (strPath.Right(4).ToLower()==".gif")
 
@@ -414,7 +414,7 @@ const CTextureArray& CGUITextureManager::Load(const CStdString& strTextureName,
 
   CTextureMap* pMap = new CTextureMap(strTextureName, width, height, 0);
   pMap->Add(pTexture, 100);
-  m_vecTextures.push_back(pMap);
+  m_textures.insert(make_pair(strTextureName, pMap));
 
 #ifdef _DEBUG_TEXTURES
   int64_t end, freq;
@@ -433,36 +433,39 @@ void CGUITextureManager::ReleaseTexture(const CStdString& strTextureName, bool i
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  iTextures i = m_textures.find(strTextureName);
+  if (i != m_textures.end())
   {
-    CTextureMap* pMap = *i;
-    if (pMap->GetName() == strTextureName)
+    CTextureMap* pMap = i->second;
+    if (pMap->Release())
     {
-      if (pMap->Release())
-      {
-        //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
-        // add to our textures to free
-        m_unusedTextures.push_back(make_pair(pMap, immediately ? 0 : XbmcThreads::SystemClockMillis()));
-        i = m_vecTextures.erase(i);
-      }
-      return;
+      //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
+      // add to our textures to free, keeping those we may reuse indexed by name
+      ilistUnused unused = m_unusedTextures.insert(m_unusedTextures.end(), make_pair(pMap, !immediately));
+      m_unusedMemUsage += pMap->GetMemoryUsage();
+      if (!immediately)
+        m_unusedIndex[strTextureName] = unused;
+      m_textures.erase(i);
     }
-    ++i;
+    return;
   }
   CLog::Log(LOGWARNING, "%s: Unable to release texture %s", __FUNCTION__, strTextureName.c_str());
 }
 
-void CGUITextureManager::FreeUnusedTextures(unsigned int timeDelay)
+void CGUITextureManager::FreeUnusedTextures(uint32_t budget)
 {
-  unsigned int currFrameTime = XbmcThreads::SystemClockMillis();
   CSingleLock lock(g_graphicsContext);
+  m_unusedBudget = budget;
   for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end();)
   {
-    if (currFrameTime - i->second >= timeDelay)
+    // a zero budget frees everything, including maps that report no memory usage
+    if (!i->second || !budget || m_unusedMemUsage > budget)
     {
-      delete i->first;
+      CTextureMap* pMap = i->first;
+      m_unusedMemUsage -= pMap->GetMemoryUsage();
+      if (i->second)
+        m_unusedIndex.erase(pMap->GetName());
+      delete pMap;
       i = m_unusedTextures.erase(i);
     }
     else
@@ -494,15 +497,13 @@ void CGUITextureManager::Cleanup()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  for (iTextures i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    CTextureMap* pMap = *i;
+    CTextureMap* pMap = i->second;
     CLog::Log(LOGWARNING, "%s: Having to cleanup texture %s", __FUNCTION__, pMap->GetName().c_str());
     delete pMap;
-    i = m_vecTextures.erase(i);
   }
+  m_textures.clear();
   for (int i = 0; i < 2; i++)
     m_TexBundle[i].Cleanup();
   FreeUnusedTextures();
@@ -510,11 +511,13 @@ void CGUITextureManager::Cleanup()
 
 void CGUITextureManager::Dump() const
 {
-  CLog::Log(LOGDEBUG, "%s: total texturemaps size:%" PRIuS, __FUNCTION__, m_vecTextures.size());
+  CLog::Log(LOGDEBUG, "%s: total texturemaps size:%" PRIuS, __FUNCTION__, m_textures.size());
+  CLog::Log(LOGDEBUG, "%s: memory used:%u unused:%u (budget %u) in %" PRIuS " unused textures, hit rate %.1f%%", __FUNCTION__,
+            GetMemoryUsage(), m_unusedMemUsage, m_unusedBudget, m_unusedTextures.size(), GetHitRate() * 100.0f);
 
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  for (ciTextures i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    const CTextureMap* pMap = m_vecTextures[i];
+    const CTextureMap* pMap = i->second;
     if (!pMap->IsEmpty())
       pMap->Dump();
   }
@@ -524,16 +527,15 @@ void CGUITextureManager::Flush()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  iTextures i = m_textures.begin();
+  while (i != m_textures.end())
   {
-    CTextureMap* pMap = *i;
+    CTextureMap* pMap = i->second;
     pMap->Flush();
     if (pMap->IsEmpty() )
     {
       delete pMap;
-      i = m_vecTextures.erase(i);
+      m_textures.erase(i++);
     }
     else
     {
@@ -545,13 +547,20 @@ void CGUITextureManager::Flush()
 unsigned int CGUITextureManager::GetMemoryUsage() const
 {
   unsigned int memUsage = 0;
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  for (ciTextures i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    memUsage += m_vecTextures[i]->GetMemoryUsage();
+    memUsage += i->second->GetMemoryUsage();
   }
   return memUsage;
 }
 
+float CGUITextureManager::GetHitRate() const
+{
+  if (!m_hits && !m_misses)
+    return 0.0f;
+  return (float)m_hits / (m_hits + m_misses);
+}
+
 void CGUITextureManager::SetTexturePath(const CStdString &texturePath)
 {
   CSingleLock lock(m_section);
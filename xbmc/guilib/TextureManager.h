@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <list>
+#include <map>
 #include "TextureBundle.h"
 #include "threads/CriticalSection.h"
 
@@ -114,6 +115,8 @@ public:
   void Cleanup();
   void Dump() const;
   uint32_t GetMemoryUsage() const;
+  uint32_t GetUnusedMemoryUsage() const { return m_unusedMemUsage; }; ///< Memory held by unused textures kept for reuse
+  float GetHitRate() const; ///< Fraction of texture loads served without loading from disk or bundle
   void Flush();
   CStdString GetTexturePath(const CStdString& textureName, bool directory = false);
   void GetBundledTexturesFromPath(const CStdString& texturePath, std::vector<CStdString> &items);
@@ -122,14 +125,25 @@ public:
   void SetTexturePath(const CStdString &texturePath);    ///< Set a single path as the path to check when loading media (clear then add)
   void RemoveTexturePath(const CStdString &texturePath); ///< Remove a path from the paths to check when loading media
 
-  void FreeUnusedTextures(unsigned int timeDelay = 0); ///< Free textures (called from app thread only)
+  /*! \brief Free unused textures (called from app thread only)
+   Unused textures are kept for reuse and freed least recently used first until the
+   remainder fits in the budget. Textures released immediately are always freed.
+   \param budget memory (in bytes) that unused textures may keep.
+   */
+  void FreeUnusedTextures(uint32_t budget = 0);
   void ReleaseHwTexture(unsigned int texture);
 protected:
-  std::vector<CTextureMap*> m_vecTextures;
-  std::list<std::pair<CTextureMap*, unsigned int> > m_unusedTextures;
+  std::map<CStdString, CTextureMap*> m_textures;
+  std::list<std::pair<CTextureMap*, bool> > m_unusedTextures; ///< least recently used first, with whether they may be reused
   std::vector<unsigned int> m_unusedHwTextures;
-  typedef std::vector<CTextureMap*>::iterator ivecTextures;
-  typedef std::list<std::pair<CTextureMap*, unsigned int> >::iterator ilistUnused;
+  typedef std::map<CStdString, CTextureMap*>::iterator iTextures;
+  typedef std::map<CStdString, CTextureMap*>::const_iterator ciTextures;
+  typedef std::list<std::pair<CTextureMap*, bool> >::iterator ilistUnused;
+  std::map<CStdString, ilistUnused> m_unusedIndex; ///< unused textures that may be reused, by name
+  uint32_t m_unusedMemUsage;
+  uint32_t m_unusedBudget;
+  unsigned int m_hits;
+  unsigned int m_misses;
   // we have 2 texture bundles (one for the base textures, one for the theme)
   CTextureBundle m_TexBundle[2];
 
@@ -19,33 +19,59 @@
  */
 
 #include <sys/stat.h>
+#include <algorithm>
 #include "XBTFReader.h"
 #include "utils/EndianSwap.h"
 #include "utils/CharsetConverter.h"
 #ifdef TARGET_WINDOWS
 #include "FileSystem/SpecialProtocol.h"
+#else
+#include <sys/mman.h>
 #endif
 
 #include <string.h>
 #include "PlatformDefs.h"
 
-#define READ_STR(str, size, file) \
-  if (!fread(str, size, 1, file)) \
-    return false;
-
-#define READ_U32(i, file) \
-  if (!fread(&i, 4, 1, file)) \
+#define READ_STR(str, size, pos) \
+  if ((pos) + (size) > m_size) \
     return false; \
+  memcpy(str, m_data + (pos), size); \
+  pos += size;
+
+#define READ_U32(i, pos) \
+  READ_STR(&i, 4, pos) \
   i = Endian_SwapLE32(i);
 
-#define READ_U64(i, file) \
-  if (!fread(&i, 8, 1, file)) \
-    return false; \
+#define READ_U64(i, pos) \
+  READ_STR(&i, 8, pos) \
   i = Endian_SwapLE64(i);
 
+namespace
+{
+  struct FileLess
+  {
+    bool operator()(CXBTFFile *lhs, CXBTFFile *rhs) const
+    {
+      return strcmp(lhs->GetPath(), rhs->GetPath()) < 0;
+    }
+    bool operator()(CXBTFFile *lhs, const char *rhs) const
+    {
+      return strcmp(lhs->GetPath(), rhs) < 0;
+    }
+  };
+}
+
 CXBTFReader::CXBTFReader()
 {
   m_file = NULL;
+  m_mapping = NULL;
+  m_data = NULL;
+  m_size = 0;
+}
+
+CXBTFReader::~CXBTFReader()
+{
+  Close();
 }
 
 bool CXBTFReader::IsOpen() const
@@ -55,6 +81,7 @@ bool CXBTFReader::IsOpen() const
 
 bool CXBTFReader::Open(const CStdString& fileName)
 {
+  Close();
   m_fileName = fileName;
 
 #ifdef TARGET_WINDOWS
@@ -69,8 +96,64 @@ bool CXBTFReader::Open(const CStdString& fileName)
     return false;
   }
 
+  if (!Map() || !ReadHeader())
+  {
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+bool CXBTFReader::Map()
+{
+#ifdef TARGET_WINDOWS
+  HANDLE file = (HANDLE)_get_osfhandle(_fileno(m_file));
+  LARGE_INTEGER size;
+  if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    return false;
+  m_mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (m_mapping == NULL)
+    return false;
+  m_data = (const unsigned char*)MapViewOfFile((HANDLE)m_mapping, FILE_MAP_READ, 0, 0, 0);
+  if (m_data == NULL)
+    return false;
+  m_size = size.QuadPart;
+#else
+  struct stat fileStat;
+  if (fstat(fileno(m_file), &fileStat) == -1 || fileStat.st_size == 0)
+    return false;
+  void *data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fileno(m_file), 0);
+  if (data == MAP_FAILED)
+    return false;
+  m_data = (const unsigned char*)data;
+  m_size = fileStat.st_size;
+#endif
+  return true;
+}
+
+void CXBTFReader::Unmap()
+{
+#ifdef TARGET_WINDOWS
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mapping)
+    CloseHandle((HANDLE)m_mapping);
+#else
+  if (m_data)
+    munmap((void*)m_data, (size_t)m_size);
+#endif
+  m_mapping = NULL;
+  m_data = NULL;
+  m_size = 0;
+}
+
+bool CXBTFReader::ReadHeader()
+{
+  uint64_t pos = 0;
+
   char magic[4];
-  READ_STR(magic, 4, m_file);
+  READ_STR(magic, 4, pos);
 
   if (strncmp(magic, XBTF_MAGIC, sizeof(magic)) != 0)
   {
@@ -78,7 +161,7 @@ bool CXBTFReader::Open(const CStdString& fileName)
   }
 
   char version[1];
-  READ_STR(version, 1, m_file);
+  READ_STR(version, 1, pos);
 
   if (strncmp(version, XBTF_VERSION, sizeof(version)) != 0)
   {
@@ -86,60 +169,74 @@ bool CXBTFReader::Open(const CStdString& fileName)
   }
 
   unsigned int nofFiles;
-  READ_U32(nofFiles, m_file);
+  READ_U32(nofFiles, pos);
+
+  // don't trust the counts in a corrupt or truncated file with the allocation
+  if (nofFiles > (m_size - pos) / CXBTFFile().GetHeaderSize())
+    return false;
+
+  std::vector<CXBTFFile>& files = m_xbtf.GetFiles();
+  files.resize(nofFiles);
   for (unsigned int i = 0; i < nofFiles; i++)
   {
-    CXBTFFile file;
+    CXBTFFile& file = files[i];
     unsigned int u32;
     uint64_t u64;
 
-    READ_STR(file.GetPath(), 256, m_file);
-    READ_U32(u32, m_file);
+    READ_STR(file.GetPath(), 256, pos);
+    file.GetPath()[255] = '\0';
+    READ_U32(u32, pos);
     file.SetLoop(u32);
 
     unsigned int nofFrames;
-    READ_U32(nofFrames, m_file);
+    READ_U32(nofFrames, pos);
 
+    if (nofFrames > (m_size - pos) / CXBTFFrame().GetHeaderSize())
+      return false;
+
+    std::vector<CXBTFFrame>& frames = file.GetFrames();
+    frames.resize(nofFrames);
     for (unsigned int j = 0; j < nofFrames; j++)
     {
-      CXBTFFrame frame;
+      CXBTFFrame& frame = frames[j];
 
-      READ_U32(u32, m_file);
+      READ_U32(u32, pos);
       frame.SetWidth(u32);
-      READ_U32(u32, m_file);
+      READ_U32(u32, pos);
       frame.SetHeight(u32);
-      READ_U32(u32, m_file);
+      READ_U32(u32, pos);
       frame.SetFormat(u32);
-      READ_U64(u64, m_file);
+      READ_U64(u64, pos);
       frame.SetPackedSize(u64);
-      READ_U64(u64, m_file);
+      READ_U64(u64, pos);
       frame.SetUnpackedSize(u64);
-      READ_U32(u32, m_file);
+      READ_U32(u32, pos);
       frame.SetDuration(u32);
-      READ_U64(u64, m_file);
+      READ_U64(u64, pos);
       frame.SetOffset(u64);
-
-      file.GetFrames().push_back(frame);
     }
-
-    m_xbtf.GetFiles().push_back(file);
-
-    m_filesMap[file.GetPath()] = file;
   }
 
   // Sanity check
-  int64_t pos = ftell(m_file);
-  if (pos != (int64_t)m_xbtf.GetHeaderSize())
+  if (pos != m_xbtf.GetHeaderSize())
   {
-    printf("Expected header size (%" PRId64") != actual size (%" PRId64")\n", m_xbtf.GetHeaderSize(), pos);
+    printf("Expected header size (%" PRId64") != actual size (%" PRId64")\n", m_xbtf.GetHeaderSize(), (int64_t)pos);
     return false;
   }
 
+  // the file table doesn't change from here on, so index it by path
+  m_index.reserve(nofFiles);
+  for (unsigned int i = 0; i < nofFiles; i++)
+    m_index.push_back(&files[i]);
+  std::stable_sort(m_index.begin(), m_index.end(), FileLess());
+
   return true;
 }
 
 void CXBTFReader::Close()
 {
+  Unmap();
+
   if (m_file)
   {
     fclose(m_file);
@@ -147,7 +244,7 @@ void CXBTFReader::Close()
   }
 
   m_xbtf.GetFiles().clear();
-  m_filesMap.clear();
+  m_index.clear();
 }
 
 time_t CXBTFReader::GetLastModificationTimestamp()
@@ -173,35 +270,34 @@ bool CXBTFReader::Exists(const CStdString& name)
 
 CXBTFFile* CXBTFReader::Find(const CStdString& name)
 {
-  std::map<CStdString, CXBTFFile>::iterator iter = m_filesMap.find(name);
-  if (iter == m_filesMap.end())
+  std::vector<CXBTFFile*>::iterator iter = std::lower_bound(m_index.begin(), m_index.end(), name.c_str(), FileLess());
+  if (iter == m_index.end() || strcmp((*iter)->GetPath(), name.c_str()) != 0)
   {
     return NULL;
   }
 
-  return &(iter->second);
+  return *iter;
 }
 
-bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
+const unsigned char* CXBTFReader::GetFrameData(const CXBTFFrame& frame) const
 {
-  if (!m_file)
-  {
-    return false;
-  }
-#if defined(TARGET_DARWIN) || defined(TARGET_FREEBSD) || defined(TARGET_ANDROID)
-    if (fseeko(m_file, (off_t)frame.GetOffset(), SEEK_SET) == -1)
-#else
-    if (fseeko64(m_file, (off_t)frame.GetOffset(), SEEK_SET) == -1)
-#endif
+  if (!m_data || frame.GetOffset() > m_size || frame.GetPackedSize() > m_size - frame.GetOffset())
   {
-    return false;
+    return NULL;
   }
 
-  if (fread(buffer, 1, (size_t)frame.GetPackedSize(), m_file) != frame.GetPackedSize())
+  return m_data + frame.GetOffset();
+}
+
+bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
+{
+  const unsigned char* data = GetFrameData(frame);
+  if (!data)
   {
     return false;
   }
 
+  memcpy(buffer, data, (size_t)frame.GetPackedSize());
   return true;
 }
 
@@ -22,14 +22,21 @@
 #define XBTFREADER_H_
 
 #include <vector>
-#include <map>
 #include "utils/StdString.h"
 #include "XBTF.h"
 
+/*!
+ \brief Reader for XBTF texture bundles.
+
+ The bundle is memory mapped on open. The header is parsed straight out of the mapping
+ into a flat file table which is sorted by path for binary lookup, and frame data is handed
+ out as pointers into the mapping so uncompressed frames need not be copied.
+ */
 class CXBTFReader
 {
 public:
   CXBTFReader();
+  ~CXBTFReader();
   bool IsOpen() const;
   bool Open(const CStdString& fileName);
   void Close();
@@ -37,13 +44,27 @@ public:
   bool Exists(const CStdString& name);
   CXBTFFile* Find(const CStdString& name);
   bool Load(const CXBTFFrame& frame, unsigned char* buffer);
+
+  /*! \brief Retrieve the (packed) data of a frame without copying it
+   The returned pointer is only valid until the reader is closed.
+   \param frame the frame to retrieve.
+   \return pointer to GetPackedSize() bytes of frame data within the bundle, NULL on failure.
+   */
+  const unsigned char* GetFrameData(const CXBTFFrame& frame) const;
   std::vector<CXBTFFile>&  GetFiles();
 
 private:
+  bool Map();
+  void Unmap();
+  bool ReadHeader();
+
   CXBTF      m_xbtf;
   CStdString m_fileName;
   FILE*      m_file;
-  std::map<CStdString, CXBTFFile> m_filesMap;
+  void*      m_mapping;        ///< file mapping handle (windows only)
+  const unsigned char* m_data; ///< the mapped bundle
+  uint64_t   m_size;           ///< size of the mapped bundle
+  std::vector<CXBTFFile*> m_index; ///< files sorted by path for lookup
 };
 
 #endif
@@ -27,6 +27,19 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*! \brief Sources of information an info bool may depend on.
+ An info bool that depends only on sources other than INFO_SOURCE_FRAME keeps
+ its value between frames until one of those sources publishes a change.
+ \sa CGUIInfoManager::InvalidateSources
+ */
+enum INFO_SOURCE
+{
+  INFO_SOURCE_NONE         = 0,      ///< constant, never changes
+  INFO_SOURCE_FRAME        = 1 << 0, ///< may change at any time, re-evaluated every frame
+  INFO_SOURCE_SKINSETTINGS = 1 << 1, ///< skin settings (Skin.HasSetting, Skin.String)
+  INFO_SOURCE_LIBRARY      = 1 << 2, ///< library content flags (Library.HasContent)
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -72,12 +85,20 @@ public:
   virtual void Update(const CGUIListItem *item) {};
 
   const std::string &GetExpression() const { return m_expression; }
+  int GetContext() const { return m_context; }
   bool ListItemDependent() const { return m_listItemDependent; }
+
+  /*! \brief Get the sources of information this info bool depends on
+   \return a combination of INFO_SOURCE flags
+   */
+  unsigned int GetSources() const { return m_sources; }
+  bool DependsOn(unsigned int sources) const { return (m_sources & sources) != 0; }
 protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
   bool m_listItemDependent;    ///< do not cache if a listitem pointer is given
+  unsigned int m_sources;      ///< INFO_SOURCE flags this info bool depends on
 
 private:
   std::string  m_expression;   ///< original expression
@@ -34,6 +34,7 @@ InfoSingle::InfoSingle(const std::string &expression, int context)
 : InfoBool(expression, context)
 {
   m_condition = g_infoManager.TranslateSingleString(expression, m_listItemDependent);
+  m_sources = m_listItemDependent ? INFO_SOURCE_FRAME : g_infoManager.GetInfoSources(m_condition);
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -44,11 +45,16 @@ void InfoSingle::Update(const CGUIListItem *item)
 InfoExpression::InfoExpression(const std::string &expression, int context)
 : InfoBool(expression, context)
 {
+  /* The expression depends on whatever its operands depend on */
+  m_sources = INFO_SOURCE_NONE;
   if (!Parse(expression))
   {
     CLog::Log(LOGERROR, "Error parsing boolean expression %s", expression.c_str());
     m_expression_tree = boost::make_shared<InfoLeaf>(g_infoManager.Register("false", 0), false);
+    m_sources = INFO_SOURCE_NONE;
   }
+  if (m_listItemDependent)
+    m_sources |= INFO_SOURCE_FRAME;
 }
 
 void InfoExpression::Update(const CGUIListItem *item)
@@ -253,6 +259,7 @@ bool InfoExpression::Parse(const std::string &expression)
         }
         /* Propagate any listItem dependency from the operand to the expression */
         m_listItemDependent |= info->ListItemDependent();
+        m_sources |= info->GetSources();
         nodes.push(boost::make_shared<InfoLeaf>(info, invert));
         /* Reuse operand string for next operand */
         operand.clear();
@@ -304,6 +311,7 @@ bool InfoExpression::Parse(const std::string &expression)
     }
     /* Propagate any listItem dependency from the operand to the expression */
     m_listItemDependent |= info->ListItemDependent();
+    m_sources |= info->GetSources();
     nodes.push(boost::make_shared<InfoLeaf>(info, invert));
   }
   while (!operator_stack.empty())
@@ -30,6 +30,7 @@
 #include "settings/Settings.h"
 #include "utils/Variant.h"
 #include "guilib/StereoscopicsManager.h"
+#include "guilib/GUIFrameProfiler.h"
 #include "windowing/WindowingFactory.h"
 
 using namespace std;
@@ -126,6 +127,27 @@ JSONRPC_STATUS CGUIOperations::GetStereoscopicModes(const std::string &method, I
   return OK;
 }
 
+JSONRPC_STATUS CGUIOperations::GetFrameProfile(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  CGUIFrameProfiler::Instance().GetTrace(result);
+  return OK;
+}
+
+JSONRPC_STATUS CGUIOperations::SetFrameProfiler(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  CGUIFrameProfiler &profiler = CGUIFrameProfiler::Instance();
+  if (parameterObject["enabled"].isString() &&
+      parameterObject["enabled"].asString().compare("toggle") == 0)
+    profiler.SetEnabled(!profiler.IsEnabled());
+  else if (parameterObject["enabled"].isBoolean())
+    profiler.SetEnabled(parameterObject["enabled"].asBoolean());
+  else
+    return InvalidParams;
+
+  result = profiler.IsEnabled();
+  return OK;
+}
+
 JSONRPC_STATUS CGUIOperations::GetPropertyValue(const std::string &property, CVariant &result)
 {
   if (property == "currentwindow")
@@ -162,6 +162,8 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
   { "GUI.SetFullscreen",                            CGUIOperations::SetFullscreen },
   { "GUI.SetStereoscopicMode",                      CGUIOperations::SetStereoscopicMode },
   { "GUI.GetStereoscopicModes",                     CGUIOperations::GetStereoscopicModes },
+  { "GUI.GetFrameProfile",                          CGUIOperations::GetFrameProfile },
+  { "GUI.SetFrameProfiler",                         CGUIOperations::SetFrameProfiler },
 
 // PVR operations
   { "PVR.GetProperties",                            CPVROperations::GetProperties },
@@ -31,6 +31,7 @@
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "guilib/Texture.h"
+#include "guilib/DDSImage.h"
 #include "guilib/imagefactory.h"
 #include "cores/FFmpeg.h"
 #if defined(HAS_OMXPLAYER)
@@ -102,14 +103,19 @@ bool CThumbnailWriter::DoWork()
   return success;
 }
 
-bool CPicture::CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest)
+bool CPicture::CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest, bool *createDDS)
 {
   return CacheTexture(texture->GetPixels(), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(),
-                      texture->GetOrientation(), dest_width, dest_height, dest);
+                      texture->GetOrientation(), dest_width, dest_height, dest, createDDS);
 }
 
-bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest)
+bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest, bool *createDDS)
 {
+  // createDDS is set again once the .dds version is written
+  const bool writeDDS = createDDS && *createDDS;
+  if (createDDS)
+    *createDDS = false;
+
   // if no max width or height is specified, don't resize
   if (dest_width == 0)
     dest_width = width;
@@ -147,6 +153,8 @@ bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, ui
         if (!orientation || OrientateImage(buffer, dest_width, dest_height, orientation))
         {
           success = CreateThumbnailFromSurface((unsigned char*)buffer, dest_width, dest_height, dest_width * 4, dest);
+          if (success && writeDDS)
+            *createDDS = CreateDDSFromSurface((unsigned char*)buffer, dest_width, dest_height, dest_width * 4, dest);
         }
       }
       delete[] buffer;
@@ -157,11 +165,26 @@ bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, ui
   { // no orientation needed
     dest_width = width;
     dest_height = height;
-    return CreateThumbnailFromSurface(pixels, width, height, pitch, dest);
+    if (!CreateThumbnailFromSurface(pixels, width, height, pitch, dest))
+      return false;
+    if (writeDDS)
+      *createDDS = CreateDDSFromSurface(pixels, width, height, pitch, dest);
+    return true;
   }
   return false;
 }
 
+bool CPicture::CreateDDSFromSurface(const unsigned char* buffer, unsigned int width, unsigned int height, unsigned int stride, const std::string &thumbFile)
+{
+  CDDSImage dds;
+  std::string ddsFile = URIUtils::ReplaceExtension(thumbFile, ".dds");
+  CLog::Log(LOGDEBUG, "Creating DDS version of: %s", thumbFile.c_str());
+  if (dds.Create(ddsFile, width, height, stride, buffer, 40))
+    return true;
+  CLog::Log(LOGERROR, "%s - failed creating %s", __FUNCTION__, ddsFile.c_str());
+  return false;
+}
+
 bool CPicture::CreateTiledThumb(const std::vector<std::string> &files, const std::string &thumb)
 {
   if (!files.size())
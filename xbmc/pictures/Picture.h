@@ -39,12 +39,24 @@ public:
    \param dest_width [in/out] maximum width in pixels of cached version - replaced with actual cached width
    \param dest_height [in/out] maximum height in pixels of cached version - replaced with actual cached height
    \param dest the output cache file
+   \param createDDS [in/out] if set and true, also write a DXT compressed .dds version alongside dest - replaced with whether the .dds version was written (defaults to NULL)
    \return true if successful, false otherwise
    */
-  static bool CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest);
-  static bool CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest);
+  static bool CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest, bool *createDDS = NULL);
+  static bool CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest, bool *createDDS = NULL);
 
 private:
+  /*! \brief Write a DXT compressed .dds version of the surface alongside the given cache file
+   Compression is done on the CPU via libsquish, so the surface written is exactly the one that was cached.
+   \param buffer the ARGB pixels of the surface
+   \param width width of the surface
+   \param height height of the surface
+   \param stride pitch of the surface
+   \param thumbFile the cache file - its extension is replaced with .dds
+   \return true if the .dds file was written, false otherwise
+   */
+  static bool CreateDDSFromSurface(const unsigned char* buffer, unsigned int width, unsigned int height, unsigned int stride, const std::string &thumbFile);
+
   static void GetScale(unsigned int width, unsigned int height, unsigned int &out_width, unsigned int &out_height);
   static bool ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
                          uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch);
@@ -146,6 +146,7 @@ void CAdvancedSettings::Initialize()
   m_videoBlackBarColour = 0;
   m_videoPPFFmpegDeint = "linblenddeint";
   m_videoPPFFmpegPostProc = "ha:128:7,va,dr";
+  m_videoFilterThreads = 0;
   m_videoDefaultPlayer = "dvdplayer";
   m_videoDefaultDVDPlayer = "dvdplayer";
   m_videoIgnoreSecondsAtStart = 3*60;
@@ -253,6 +254,7 @@ void CAdvancedSettings::Initialize()
   m_fanartRes = 1080;
   m_imageRes = 720;
   m_useDDSFanart = false;
+  m_imageDecodeBudget = 64;
 
   m_sambaclienttimeout = 10;
   m_sambadoscodepage = "";
@@ -381,6 +383,10 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiDirtyRegionNoFlipTimeout = 0;
+  m_guiDirtyRegionPassCost = 10.0f;
+  m_guiDirtyRegionPixelCost = 0.01f;
+  m_guiFrameProfiler = false;
+  m_guiUnusedTextureMemory = 32;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
 
@@ -584,6 +590,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetString(pElement,"cleandatetime", m_videoCleanDateTimeRegExp);
     XMLUtils::GetString(pElement,"ppffmpegdeinterlacing",m_videoPPFFmpegDeint);
     XMLUtils::GetString(pElement,"ppffmpegpostprocessing",m_videoPPFFmpegPostProc);
+    XMLUtils::GetInt(pElement, "filterthreads", m_videoFilterThreads, 0, 16);
     XMLUtils::GetInt(pElement,"vdpauscaling",m_videoVDPAUScaling);
     // There is a large amount of drivers implementing VAAPI in a non stable way
     // the forcevaapienabled setting let's the user decide to use it nevertheless
@@ -1033,6 +1040,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetFloat(pRootElement, "controllerdeadzone", m_controllerDeadzone, 0.0f, 1.0f);
   XMLUtils::GetUInt(pRootElement, "fanartres", m_fanartRes, 0, 1080);
   XMLUtils::GetUInt(pRootElement, "imageres", m_imageRes, 0, 1080);
+  XMLUtils::GetUInt(pRootElement, "imagedecodebudget", m_imageDecodeBudget, 8, 1024);
 #if !defined(TARGET_RASPBERRY_PI)
   XMLUtils::GetBoolean(pRootElement, "useddsfanart", m_useDDSFanart);
 #endif
@@ -1174,6 +1182,10 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetFloat(pElement, "dirtyregionpasscost",     m_guiDirtyRegionPassCost, 0.0f, 1000000.0f);
+    XMLUtils::GetFloat(pElement, "dirtyregionpixelcost",    m_guiDirtyRegionPixelCost, 0.0f, 1000.0f);
+    XMLUtils::GetBoolean(pElement, "frameprofiler",         m_guiFrameProfiler);
+    XMLUtils::GetUInt(pElement, "unusedtexturememory",      m_guiUnusedTextureMemory, 0, 1024);
   }
 
   // load in the settings overrides
@@ -162,6 +162,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_videoPercentSeekBackwardBig;
     CStdString m_videoPPFFmpegDeint;
     CStdString m_videoPPFFmpegPostProc;
+    int m_videoFilterThreads; ///< \brief threads for software video filters such as yadif, 0 for one per core
     bool m_videoVDPAUtelecine;
     bool m_videoVDPAUdeintSkipChromaHD;
     bool m_musicUseTimeSeeking;
@@ -250,6 +251,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
      */
     unsigned int GetThumbSize() const { return m_imageRes / 2; };
     bool m_useDDSFanart;
+    unsigned int m_imageDecodeBudget; ///< \brief memory (in MB) that concurrent texture cache decodes may hold
 
     int m_sambaclienttimeout;
     CStdString m_sambadoscodepage;
@@ -375,6 +377,10 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    float m_guiDirtyRegionPassCost;  ///< \brief estimated overhead of one rendering pass, used by the merging dirty region solver
+    float m_guiDirtyRegionPixelCost; ///< \brief estimated cost of rendering one pixel, used by the merging dirty region solver
+    bool m_guiFrameProfiler; ///< \brief whether to record frame timings from startup, see CGUIFrameProfiler
+    unsigned int m_guiUnusedTextureMemory; ///< \brief memory (in MB) unused gui textures may keep so they are reused rather than reloaded
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
@@ -88,6 +88,8 @@ void CSkinSettings::SetString(int setting, const string &label)
   if (it != m_strings.end())
   {
     it->second.value = label;
+    lock.Leave();
+    g_infoManager.InvalidateSources(INFO::INFO_SOURCE_SKINSETTINGS);
     return;
   }
 
@@ -135,6 +137,8 @@ void CSkinSettings::SetBool(int setting, bool set)
   if (it != m_bools.end())
   {
     it->second.value = set;
+    lock.Leave();
+    g_infoManager.InvalidateSources(INFO::INFO_SOURCE_SKINSETTINGS);
     return;
   }
 
@@ -153,6 +157,8 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value.clear();
+      lock.Leave();
+      g_infoManager.InvalidateSources(INFO::INFO_SOURCE_SKINSETTINGS);
       return;
     }
   }
@@ -163,6 +169,8 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value = false;
+      lock.Leave();
+      g_infoManager.InvalidateSources(INFO::INFO_SOURCE_SKINSETTINGS);
       return;
     }
   }
@@ -186,7 +194,8 @@ void CSkinSettings::Reset()
       it->second.value.clear();
   }
 
-  g_infoManager.ResetCache();
+  lock.Leave();
+  g_infoManager.InvalidateSources(INFO::INFO_SOURCE_SKINSETTINGS);
 }
 
 bool CSkinSettings::Load(const TiXmlNode *settings)
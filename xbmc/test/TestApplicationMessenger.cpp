@@ -0,0 +1,277 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ApplicationMessenger.h"
+#include "GUIUserMessages.h"
+#include "guilib/GUIWindowManager.h"
+#include "guilib/IMsgTargetCallback.h"
+#include "threads/Atomics.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+struct MessageResults
+{
+  MessageResults(unsigned int producers) :
+    received(0), outOfOrder(0), totalLatency(0), maxLatency(0), lastSequence(producers, -1) {}
+
+  volatile long received;
+  long outOfOrder;
+  int64_t totalLatency;
+  int64_t maxLatency;
+  std::vector<int> lastSequence;
+};
+
+struct TimedMessage
+{
+  ThreadMessageCallback callback;
+  MessageResults *results;
+  unsigned int producer;
+  int sequence;
+  int64_t sent;
+};
+
+// only ever called from the thread processing the messages
+void OnTimedMessage(void *userptr)
+{
+  TimedMessage *message = (TimedMessage *)userptr;
+  MessageResults *results = message->results;
+
+  int64_t latency = CurrentHostCounter() - message->sent;
+  results->totalLatency += latency;
+  if (latency > results->maxLatency)
+    results->maxLatency = latency;
+
+  if (message->sequence <= results->lastSequence[message->producer])
+    results->outOfOrder++;
+  results->lastSequence[message->producer] = message->sequence;
+
+  AtomicIncrement(&results->received);
+}
+
+class CMessageProducer : public CThread
+{
+public:
+  CMessageProducer(MessageResults &results, unsigned int producer, int count, bool wait) :
+    CThread("TestApplicationMessenger"), m_messages(count), m_wait(wait)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      m_messages[i].callback.callback = OnTimedMessage;
+      m_messages[i].callback.userptr = &m_messages[i];
+      m_messages[i].results = &results;
+      m_messages[i].producer = producer;
+      m_messages[i].sequence = i;
+      m_messages[i].sent = 0;
+    }
+  }
+
+  virtual void Process()
+  {
+    for (size_t i = 0; i < m_messages.size(); i++)
+    {
+      ThreadMessage tMsg = {TMSG_CALLBACK};
+      tMsg.lpVoid = &m_messages[i].callback;
+      m_messages[i].sent = CurrentHostCounter();
+      CApplicationMessenger::Get().SendMessage(tMsg, m_wait);
+    }
+  }
+
+private:
+  std::vector<TimedMessage> m_messages;
+  bool m_wait;
+};
+
+/* Send count messages from each of the producer threads and process them
+ * on this thread, the way the application thread does every frame.
+ */
+bool RunProducers(MessageResults &results, unsigned int producers, int count, bool wait, unsigned int milliseconds)
+{
+  std::vector<CMessageProducer*> threads;
+  for (unsigned int i = 0; i < producers; i++)
+    threads.push_back(new CMessageProducer(results, i, count, wait));
+  for (unsigned int i = 0; i < producers; i++)
+    threads[i]->Create();
+
+  const long total = producers * count;
+  XbmcThreads::EndTime timeout(milliseconds);
+  while (results.received < total && !timeout.IsTimePast())
+  {
+    CApplicationMessenger::Get().ProcessMessages();
+    XbmcThreads::ThreadSleep(0);
+  }
+
+  // release any producer that is still waiting on its message
+  CApplicationMessenger::Get().Cleanup();
+  for (unsigned int i = 0; i < producers; i++)
+  {
+    threads[i]->StopThread(true);
+    delete threads[i];
+  }
+  return results.received >= total;
+}
+}
+
+namespace
+{
+const int coalesceSender = 0x7E57;
+
+/* Records the GUI messages of the coalescing tests as they're delivered. The
+ * window manager can't drop its targets, so there is just the one recorder.
+ */
+class CMessageRecorder : public IMsgTargetCallback
+{
+public:
+  static CMessageRecorder &Get()
+  {
+    static CMessageRecorder recorder;
+    return recorder;
+  }
+
+  virtual bool OnMessage(CGUIMessage &message)
+  {
+    if (message.GetSenderId() == coalesceSender)
+      m_messages.push_back(message);
+    return false;
+  }
+
+  std::vector<CGUIMessage> m_messages;
+
+private:
+  CMessageRecorder() { g_windowManager.AddMsgTarget(this); }
+};
+
+std::vector<CGUIMessage> &ProcessGUIMessages()
+{
+  CMessageRecorder::Get().m_messages.clear();
+  CApplicationMessenger::Get().ProcessMessages();
+  return CMessageRecorder::Get().m_messages;
+}
+}
+
+TEST(TestApplicationMessenger, CoalesceRefreshMessages)
+{
+  CMessageRecorder::Get();
+  CGUIMessage update(GUI_MSG_UPDATE, coalesceSender, 0);
+  CGUIMessage notify(GUI_MSG_NOTIFY_ALL, coalesceSender, 0, GUI_MSG_UPDATE_ITEM);
+  CGUIMessage label(GUI_MSG_LABEL_SET, coalesceSender, 0);
+
+  for (int i = 0; i < 3; i++)
+  {
+    CApplicationMessenger::Get().SendGUIMessage(update, WINDOW_INVALID, false);
+    CApplicationMessenger::Get().SendGUIMessage(notify, WINDOW_INVALID, false);
+  }
+  CApplicationMessenger::Get().SendGUIMessage(label, WINDOW_INVALID, false);
+  CApplicationMessenger::Get().SendGUIMessage(update, WINDOW_INVALID, false);
+  CApplicationMessenger::Get().SendGUIMessage(notify, WINDOW_INVALID, false);
+
+  // only the last of each refresh is delivered, and the other message isn't held back by them
+  std::vector<CGUIMessage> &messages = ProcessGUIMessages();
+  ASSERT_EQ(3U, messages.size());
+  EXPECT_EQ(GUI_MSG_LABEL_SET, messages[0].GetMessage());
+  EXPECT_EQ(GUI_MSG_UPDATE, messages[1].GetMessage());
+  EXPECT_EQ(GUI_MSG_NOTIFY_ALL, messages[2].GetMessage());
+  EXPECT_EQ(GUI_MSG_UPDATE_ITEM, messages[2].GetParam1());
+}
+
+TEST(TestApplicationMessenger, CoalesceOnlyIdenticalMessages)
+{
+  CMessageRecorder::Get();
+  CGUIMessage item(GUI_MSG_NOTIFY_ALL, coalesceSender, 0, GUI_MSG_UPDATE_ITEM);
+  CGUIMessage thumbs(GUI_MSG_NOTIFY_ALL, coalesceSender, 0, GUI_MSG_REFRESH_THUMBS);
+  int data = 0;
+  CGUIMessage pointer(GUI_MSG_UPDATE, coalesceSender, 0);
+  pointer.SetPointer(&data);
+
+  // different param1 of the gui message
+  CApplicationMessenger::Get().SendGUIMessage(item, WINDOW_INVALID, false);
+  CApplicationMessenger::Get().SendGUIMessage(thumbs, WINDOW_INVALID, false);
+  // messages with a pointer
+  CApplicationMessenger::Get().SendGUIMessage(pointer, WINDOW_INVALID, false);
+  CApplicationMessenger::Get().SendGUIMessage(pointer, WINDOW_INVALID, false);
+  // the same message for another window (param1 of the thread message), which isn't delivered
+  // here as there is no such window
+  CGUIMessage update(GUI_MSG_UPDATE, coalesceSender, 0);
+  CApplicationMessenger::Get().SendGUIMessage(update, WINDOW_INVALID, false);
+  CApplicationMessenger::Get().SendGUIMessage(update, WINDOW_HOME, false);
+
+  std::vector<CGUIMessage> &messages = ProcessGUIMessages();
+  ASSERT_EQ(5U, messages.size());
+  EXPECT_EQ(GUI_MSG_UPDATE_ITEM, messages[0].GetParam1());
+  EXPECT_EQ(GUI_MSG_REFRESH_THUMBS, messages[1].GetParam1());
+  EXPECT_EQ(&data, messages[2].GetPointer());
+  EXPECT_EQ(&data, messages[3].GetPointer());
+  EXPECT_EQ(GUI_MSG_UPDATE, messages[4].GetMessage());
+  EXPECT_TRUE(messages[4].GetPointer() == NULL);
+}
+
+TEST(TestApplicationMessenger, MessagesFromManyThreads)
+{
+  MessageResults results(4);
+  EXPECT_TRUE(RunProducers(results, 4, 1000, false, 30000));
+  EXPECT_EQ(4000, results.received);
+  EXPECT_EQ(0, results.outOfOrder);
+}
+
+TEST(TestApplicationMessenger, WaitForMessages)
+{
+  MessageResults results(2);
+  EXPECT_TRUE(RunProducers(results, 2, 100, true, 30000));
+  EXPECT_EQ(200, results.received);
+  EXPECT_EQ(0, results.outOfOrder);
+}
+
+TEST(TestApplicationMessenger, WaitFromManyThreads)
+{
+  // more waiting senders than nodes are pooled, so that recycled nodes get deleted
+  // while the other side may still be using them
+  MessageResults results(100);
+  EXPECT_TRUE(RunProducers(results, 100, 100, true, 60000));
+  EXPECT_EQ(10000, results.received);
+  EXPECT_EQ(0, results.outOfOrder);
+}
+
+TEST(TestApplicationMessenger, DISABLED_Benchmark_Latency)
+{
+  static const bool wait[] = { false, true };
+  for (unsigned int i = 0; i < sizeof(wait) / sizeof(wait[0]); i++)
+  {
+    const unsigned int producers = 4;
+    const int count = wait[i] ? 10000 : 100000;
+    MessageResults results(producers);
+
+    int64_t start = CurrentHostCounter();
+    EXPECT_TRUE(RunProducers(results, producers, count, wait[i], 120000));
+    double elapsed = (double)(CurrentHostCounter() - start) / CurrentHostFrequency();
+    double toMicroseconds = 1000000.0 / CurrentHostFrequency();
+
+    std::cout << results.received << (wait[i] ? " synchronous" : " asynchronous") << " messages from "
+              << producers << " threads: " << results.received / elapsed << " messages/s, latency "
+              << results.totalLatency * toMicroseconds / results.received << "us average, "
+              << results.maxLatency * toMicroseconds << "us max" << std::endl;
+  }
+}
@@ -0,0 +1,147 @@
+/*
+ *      Copyright (C) 2014 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/DirtyRegionSolvers.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+const float costPerPass = 100.0f;
+const float costPerArea = 0.01f;
+
+float Cost(const CDirtyRegionList &regions)
+{
+  float cost = 0.0f;
+  for (unsigned int i = 0; i < regions.size(); i++)
+    cost += costPerPass + costPerArea * regions[i].Area();
+  return cost;
+}
+
+bool Contains(const CRect &outer, const CRect &inner)
+{
+  return inner.x1 >= outer.x1 && inner.y1 >= outer.y1 && inner.x2 <= outer.x2 && inner.y2 <= outer.y2;
+}
+
+// every input region must be rendered as part of one of the output regions
+void ExpectCovered(const CDirtyRegionList &input, const CDirtyRegionList &output)
+{
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    bool covered = false;
+    for (unsigned int j = 0; j < output.size() && !covered; j++)
+      covered = Contains(output[j], input[i]);
+    EXPECT_TRUE(covered) << "region " << i << " is not covered";
+  }
+}
+
+CDirtyRegionList Solve(IDirtyRegionSolver &solver, const CDirtyRegionList &input)
+{
+  CDirtyRegionList output;
+  solver.Solve(input, output);
+  return output;
+}
+}
+
+TEST(TestDirtyRegionSolvers, MergingEmpty)
+{
+  CMergingDirtyRegionSolver solver(costPerPass, costPerArea);
+  CDirtyRegionList input;
+  input.push_back(CDirtyRegion());
+
+  EXPECT_TRUE(Solve(solver, input).empty());
+}
+
+TEST(TestDirtyRegionSolvers, MergingKeepsDistantRegionsApart)
+{
+  CMergingDirtyRegionSolver solver(costPerPass, costPerArea);
+  CDirtyRegionList input;
+  input.push_back(CDirtyRegion(0, 0, 10, 10));
+  input.push_back(CDirtyRegion(1900, 1000, 1910, 1010));
+
+  CDirtyRegionList output = Solve(solver, input);
+  EXPECT_EQ(2U, output.size());
+  ExpectCovered(input, output);
+}
+
+TEST(TestDirtyRegionSolvers, MergingJoinsOverlappingRegions)
+{
+  CMergingDirtyRegionSolver solver(costPerPass, costPerArea);
+  CDirtyRegionList input;
+  input.push_back(CDirtyRegion(0, 0, 100, 100));
+  input.push_back(CDirtyRegion(50, 50, 150, 150));
+
+  CDirtyRegionList output = Solve(solver, input);
+  ASSERT_EQ(1U, output.size());
+  EXPECT_FLOAT_EQ(0.0f, output[0].x1);
+  EXPECT_FLOAT_EQ(0.0f, output[0].y1);
+  EXPECT_FLOAT_EQ(150.0f, output[0].x2);
+  EXPECT_FLOAT_EQ(150.0f, output[0].y2);
+}
+
+TEST(TestDirtyRegionSolvers, MergingAgainstUnionAndGreedy)
+{
+  // a row of small regions (say a spectrum) and one far away (say a clock)
+  CDirtyRegionList input;
+  for (int i = 0; i < 10; i++)
+    input.push_back(CDirtyRegion(i * 30.0f, 0, i * 30.0f + 20, 20));
+  input.push_back(CDirtyRegion(1800, 1000, 1820, 1020));
+
+  CMergingDirtyRegionSolver merging(costPerPass, costPerArea);
+  CUnionDirtyRegionSolver unified;
+  CGreedyDirtyRegionSolver greedy;
+
+  CDirtyRegionList merged = Solve(merging, input);
+  CDirtyRegionList unions = Solve(unified, input);
+  CDirtyRegionList greedies = Solve(greedy, input);
+
+  ExpectCovered(input, merged);
+  ExpectCovered(input, unions);
+  ExpectCovered(input, greedies);
+
+  EXPECT_EQ(2U, merged.size());
+  EXPECT_LT(Cost(merged), Cost(unions));
+  EXPECT_LE(Cost(merged), Cost(greedies));
+}
+
+TEST(TestDirtyRegionSolvers, MergingNeverCostsMore)
+{
+  // scattered regions from a fixed pseudo random sequence
+  CDirtyRegionList input;
+  unsigned int seed = 1;
+  for (int i = 0; i < 100; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    float x = (float)((seed >> 16) % 1800);
+    seed = seed * 1103515245 + 12345;
+    float y = (float)((seed >> 16) % 1000);
+    seed = seed * 1103515245 + 12345;
+    float size = (float)((seed >> 16) % 100 + 1);
+    input.push_back(CDirtyRegion(x, y, x + size, y + size));
+  }
+
+  CMergingDirtyRegionSolver solver(costPerPass, costPerArea);
+  CDirtyRegionList output = Solve(solver, input);
+
+  ExpectCovered(input, output);
+  EXPECT_LE(output.size(), input.size());
+  // each merge lowers the cost, so we can't be worse than rendering the input as is
+  EXPECT_LE(Cost(output), Cost(input));
+}
@@ -21,6 +21,7 @@
 #include "FileItem.h"
 #include "URL.h"
 #include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
 
 #include "gtest/gtest.h"
 
@@ -136,3 +137,44 @@ const TestFileData BaseMovies[] = {{ "c:\\dir\\filename.avi", false, "c:\\dir\\f
                                    { "/home/user/movies/movie_name/BDMV/index.bdmv", true, "/home/user/movies/movie_name/" }};
 
 INSTANTIATE_TEST_CASE_P(BaseNameMovies, TestFileItemBasePath, ValuesIn(BaseMovies));
+
+TEST(TestFileItemList, FastLookup)
+{
+  CFileItemList items;
+  items.SetFastLookup(true);
+  for (int i = 0; i < 1000; i++)
+  {
+    CFileItemPtr item(new CFileItem(StringUtils::Format("/home/user/music/%04i.mp3", i), false));
+    items.Add(item);
+  }
+
+  // a second item with the same path doesn't replace the first one
+  CFileItemPtr duplicate(new CFileItem("/home/user/music/0010.mp3", false));
+  items.Add(duplicate);
+
+  EXPECT_EQ(1001, items.Size());
+  EXPECT_TRUE(items.Contains("/home/user/music/0999.mp3"));
+  EXPECT_FALSE(items.Contains("/home/user/music/1000.mp3"));
+  EXPECT_EQ(items[10], items.Get("/home/user/music/0010.mp3"));
+  EXPECT_NE(duplicate, items.Get("/home/user/music/0010.mp3"));
+
+  items.Remove(500);
+  EXPECT_FALSE(items.Contains("/home/user/music/0500.mp3"));
+  EXPECT_FALSE(items.Get("/home/user/music/0500.mp3"));
+  EXPECT_TRUE(items.Contains("/home/user/music/0501.mp3"));
+
+  // the index is rebuilt from the items when enabled again
+  items.SetFastLookup(false);
+  items.SetFastLookup(true);
+  EXPECT_FALSE(items.Contains("/home/user/music/0500.mp3"));
+  EXPECT_EQ(items[10], items.Get("/home/user/music/0010.mp3"));
+
+  CFileItemList appended;
+  appended.SetFastLookup(true);
+  appended.Append(items);
+  EXPECT_EQ(items.Size(), appended.Size());
+  EXPECT_EQ(items[998], appended.Get("/home/user/music/0999.mp3"));
+
+  items.Clear();
+  EXPECT_FALSE(items.Contains("/home/user/music/0001.mp3"));
+}
@@ -0,0 +1,46 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+#include "threads/platform/linux/Futex.h"
+
+/**
+ * A CFastEvent has the interface of a CEvent, but neither setting nor waiting
+ *  on it takes a lock on Linux. Elsewhere it falls back to a CEvent.
+ *
+ * An auto reset CFastEvent releases a single waiter for every Set(), and it
+ *  can't be waited on as part of a CEventGroup.
+ */
+class CFastEvent : public XbmcThreads::futex::Event
+{
+public:
+  inline CFastEvent(bool manual = false, bool signaled_ = false) : XbmcThreads::futex::Event(manual, signaled_) {}
+};
+#else
+#include "threads/Event.h"
+
+class CFastEvent : public CEvent
+{
+public:
+  inline CFastEvent(bool manual = false, bool signaled_ = false) : CEvent(manual, signaled_) {}
+};
+#endif
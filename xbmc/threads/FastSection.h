@@ -0,0 +1,90 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "threads/Lockables.h"
+
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+#include "threads/platform/linux/Futex.h"
+#else
+#include "threads/CriticalSection.h"
+#include "threads/SharedSection.h"
+#endif
+
+/**
+ * A CFastSection is a non-recursive Lockable for short, hot critical sections.
+ *  On Linux it's a futex that only enters the kernel when contended, elsewhere
+ *  it falls back to a CCriticalSection.
+ *
+ * Unlike a CCriticalSection it can't be used with a ConditionVariable or
+ *  CSingleExit, and must never be locked again by the thread holding it.
+ */
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+class CFastSection : public XbmcThreads::futex::Mutex {};
+#else
+class CFastSection : public CCriticalSection {};
+#endif
+
+/**
+ * A CFastSharedSection satisfies the Shared Lockable concept (see Lockables.h)
+ *  like CSharedSection, but its exclusive lock isn't recursive. On Linux
+ *  neither lock takes a mutex, elsewhere it falls back to a CSharedSection.
+ */
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+class CFastSharedSection : public XbmcThreads::futex::SharedMutex {};
+#else
+class CFastSharedSection : public CSharedSection {};
+#endif
+
+/**
+ * This implements a "guard" pattern for a CFastSection, see CSingleLock.
+ */
+class CFastLock : public XbmcThreads::UniqueLock<CFastSection>
+{
+public:
+  inline CFastLock(CFastSection& cs) : XbmcThreads::UniqueLock<CFastSection>(cs) {}
+  inline CFastLock(const CFastSection& cs) : XbmcThreads::UniqueLock<CFastSection>((CFastSection&)cs) {}
+
+  inline void Leave() { unlock(); }
+  inline void Enter() { lock(); }
+};
+
+class CFastSharedLock : public XbmcThreads::SharedLock<CFastSharedSection>
+{
+public:
+  inline CFastSharedLock(CFastSharedSection& cs) : XbmcThreads::SharedLock<CFastSharedSection>(cs) {}
+  inline CFastSharedLock(const CFastSharedSection& cs) : XbmcThreads::SharedLock<CFastSharedSection>((CFastSharedSection&)cs) {}
+
+  inline bool IsOwner() const { return owns_lock(); }
+  inline void Enter() { lock(); }
+  inline void Leave() { unlock(); }
+};
+
+class CFastExclusiveLock : public XbmcThreads::UniqueLock<CFastSharedSection>
+{
+public:
+  inline CFastExclusiveLock(CFastSharedSection& cs) : XbmcThreads::UniqueLock<CFastSharedSection>(cs) {}
+  inline CFastExclusiveLock(const CFastSharedSection& cs) : XbmcThreads::UniqueLock<CFastSharedSection>((CFastSharedSection&)cs) {}
+
+  inline bool IsOwner() const { return owns_lock(); }
+  inline void Leave() { unlock(); }
+  inline void Enter() { lock(); }
+};
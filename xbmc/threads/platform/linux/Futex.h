@@ -0,0 +1,238 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "threads/Helpers.h"
+#include "threads/SystemClock.h"
+
+#ifndef FUTEX_WAIT_PRIVATE
+#define FUTEX_WAIT_PRIVATE FUTEX_WAIT
+#define FUTEX_WAKE_PRIVATE FUTEX_WAKE
+#endif
+
+namespace XbmcThreads
+{
+  namespace futex
+  {
+    /**
+     * Sleep while *addr is still equal to 'expected', until woken by FutexWake
+     *  or until 'milliSeconds' have passed. Spurious returns are possible, so
+     *  callers always check their condition again.
+     */
+    inline void FutexWait(volatile int* addr, int expected, unsigned int milliSeconds = EndTime::InfiniteValue)
+    {
+      if (milliSeconds == EndTime::InfiniteValue)
+        syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+      else
+      {
+        struct timespec timeout;
+        timeout.tv_sec = milliSeconds / 1000;
+        timeout.tv_nsec = (milliSeconds % 1000) * 1000000;
+        syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, &timeout, NULL, 0);
+      }
+    }
+
+    inline void FutexWake(volatile int* addr, int count)
+    {
+      syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+    }
+
+    /**
+     * A non-recursive mutex that only enters the kernel when contended
+     *  (see "Futexes Are Tricky", U. Drepper).
+     */
+    class Mutex : public NonCopyable
+    {
+      volatile int state; // 0 unlocked, 1 locked, 2 locked and contended
+
+    public:
+      inline Mutex() : state(0) {}
+
+      inline void lock()
+      {
+        int c = __sync_val_compare_and_swap(&state, 0, 1);
+        if (c == 0)
+          return;
+
+        // the lock is usually held for a very short time, so spin a little before sleeping
+        for (int i = 0; i < 100 && c == 1; i++)
+        {
+          c = __sync_val_compare_and_swap(&state, 0, 1);
+          if (c == 0)
+            return;
+        }
+
+        if (c != 2)
+          c = __sync_lock_test_and_set(&state, 2);
+        while (c != 0)
+        {
+          FutexWait(&state, 2);
+          c = __sync_lock_test_and_set(&state, 2);
+        }
+      }
+
+      inline bool try_lock() { return __sync_bool_compare_and_swap(&state, 0, 1); }
+
+      inline void unlock()
+      {
+        if (__sync_fetch_and_sub(&state, 1) != 1)
+        {
+          __sync_lock_release(&state);
+          FutexWake(&state, 1);
+        }
+      }
+    };
+
+    /**
+     * A Shared Lockable (see Lockables.h) with the same semantics as CSharedSection,
+     *  except that the exclusive lock isn't recursive. Waiting writers don't block new
+     *  readers, so the shared lock can still be taken recursively.
+     */
+    class SharedMutex : public NonCopyable
+    {
+      volatile int state;   // number of readers, or -1 when held exclusively
+      volatile int waiters; // number of threads sleeping on state
+
+      inline void wait(int expected)
+      {
+        __sync_fetch_and_add(&waiters, 1);
+        FutexWait(&state, expected);
+        __sync_fetch_and_sub(&waiters, 1);
+      }
+
+      inline void wakeAll() { if (waiters) FutexWake(&state, INT_MAX); }
+
+    public:
+      inline SharedMutex() : state(0), waiters(0) {}
+
+      inline void lock()
+      {
+        for (;;)
+        {
+          const int s = __sync_val_compare_and_swap(&state, 0, -1);
+          if (s == 0)
+            return;
+          wait(s);
+        }
+      }
+
+      inline bool try_lock() { return __sync_bool_compare_and_swap(&state, 0, -1); }
+
+      inline void unlock()
+      {
+        __sync_val_compare_and_swap(&state, -1, 0);
+        wakeAll();
+      }
+
+      inline void lock_shared()
+      {
+        for (;;)
+        {
+          const int s = state;
+          if (s >= 0)
+          {
+            if (__sync_bool_compare_and_swap(&state, s, s + 1))
+              return;
+          }
+          else
+            wait(s);
+        }
+      }
+
+      inline bool try_lock_shared()
+      {
+        for (;;)
+        {
+          const int s = state;
+          if (s < 0)
+            return false;
+          if (__sync_bool_compare_and_swap(&state, s, s + 1))
+            return true;
+        }
+      }
+
+      inline void unlock_shared()
+      {
+        if (__sync_sub_and_fetch(&state, 1) == 0)
+          wakeAll();
+      }
+    };
+
+    /**
+     * An event that doesn't take a lock to be set or waited on. Unlike CEvent, an
+     *  auto reset Event releases a single waiter per Set(), and it can't be part of
+     *  a CEventGroup.
+     */
+    class Event : public NonCopyable
+    {
+      volatile int signaled;
+      volatile int waiters; // number of threads sleeping on signaled
+      bool manualReset;
+
+      // take the signal, or only check it for manual reset events
+      inline bool consume()
+      {
+        return manualReset ? signaled != 0 : __sync_bool_compare_and_swap(&signaled, 1, 0);
+      }
+
+    public:
+      inline Event(bool manual = false, bool signaled_ = false) : signaled(signaled_ ? 1 : 0), waiters(0), manualReset(manual) {}
+
+      inline void Set()
+      {
+        __sync_lock_test_and_set(&signaled, 1);
+        __sync_synchronize();
+        if (waiters)
+          FutexWake(&signaled, manualReset ? INT_MAX : 1);
+      }
+
+      inline void Reset() { __sync_lock_release(&signaled); }
+
+      inline bool Signaled() { __sync_synchronize(); return signaled != 0; }
+
+      inline bool WaitMSec(unsigned int milliSeconds)
+      {
+        EndTime endTime(milliSeconds);
+        for (;;)
+        {
+          if (consume())
+            return true;
+
+          const unsigned int left = endTime.MillisLeft();
+          if (left == 0)
+            return false;
+
+          __sync_fetch_and_add(&waiters, 1);
+          FutexWait(&signaled, 0, left);
+          __sync_fetch_and_sub(&waiters, 1);
+        }
+      }
+
+      inline bool Wait() { return WaitMSec(EndTime::InfiniteValue); }
+    };
+  }
+}
@@ -0,0 +1,265 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/FastSection.h"
+#include "threads/FastEvent.h"
+#include "threads/SharedSection.h"
+#include "threads/SingleLock.h"
+#include "threads/Event.h"
+#include "threads/test/TestHelpers.h"
+#include "utils/Stopwatch.h"
+
+#include <iostream>
+#include <vector>
+
+//=============================================================================
+// Helper classes
+//=============================================================================
+
+template<class S, class L>
+class counter : public IRunnable
+{
+  S& sec;
+  long& count;
+  int iterations;
+public:
+  inline counter(S& sec_, long& count_, int iterations_) : sec(sec_), count(count_), iterations(iterations_) {}
+
+  void Run()
+  {
+    for (int i = 0; i < iterations; i++)
+    {
+      L lock(sec);
+      count++;
+    }
+  }
+};
+
+template<class S>
+class readerWriter : public IRunnable
+{
+  S& sec;
+  int iterations;
+  volatile long started;
+public:
+  volatile long readers;
+  volatile bool writing;
+  volatile long failures;
+
+  inline readerWriter(S& sec_, int iterations_) : sec(sec_), iterations(iterations_), started(0), readers(0), writing(false), failures(0) {}
+
+  void Run()
+  {
+    // every tenth lock is exclusive, starting at a different point for every thread
+    const int first = AtomicIncrement(&started);
+    for (int i = first; i < first + iterations; i++)
+    {
+      if (i % 10 == 0)
+      {
+        sec.lock();
+        if (writing || readers)
+          AtomicIncrement(&failures);
+        writing = true;
+        writing = false;
+        sec.unlock();
+      }
+      else
+      {
+        sec.lock_shared();
+        AtomicIncrement(&readers);
+        if (writing)
+          AtomicIncrement(&failures);
+        AtomicDecrement(&readers);
+        sec.unlock_shared();
+      }
+    }
+  }
+};
+
+template<class E>
+class pingPong : public IRunnable
+{
+  E& ping;
+  E& pong;
+  int iterations;
+public:
+  inline pingPong(E& ping_, E& pong_, int iterations_) : ping(ping_), pong(pong_), iterations(iterations_) {}
+
+  void Run()
+  {
+    for (int i = 0; i < iterations; i++)
+    {
+      ping.Wait();
+      pong.Set();
+    }
+  }
+};
+
+template<class R>
+static void runThreads(R& runnable, int numThreads)
+{
+  std::vector<thread> threads;
+  for (int i = 0; i < numThreads; i++)
+    threads.push_back(thread(runnable));
+  for (int i = 0; i < numThreads; i++)
+    threads[i].join();
+}
+
+template<class S, class L>
+static float timeContention(int numThreads, int iterations)
+{
+  S sec;
+  long count = 0;
+  counter<S, L> c(sec, count, iterations);
+  CStopWatch watch;
+  watch.StartZero();
+  runThreads(c, numThreads);
+  EXPECT_EQ((long)numThreads * iterations, count);
+  return watch.GetElapsedMilliseconds();
+}
+
+template<class E>
+static float timePingPong(int iterations)
+{
+  E ping, pong;
+  pingPong<E> p(ping, pong, iterations);
+  CStopWatch watch;
+  watch.StartZero();
+  thread t(p);
+  for (int i = 0; i < iterations; i++)
+  {
+    ping.Set();
+    pong.Wait();
+  }
+  t.join();
+  return watch.GetElapsedMilliseconds();
+}
+
+//=============================================================================
+
+TEST(TestFastSection, General)
+{
+  CFastSection sec;
+
+  CFastLock l1(sec);
+  EXPECT_TRUE(l1.owns_lock());
+  l1.Leave();
+  EXPECT_FALSE(l1.owns_lock());
+  EXPECT_TRUE(sec.try_lock());
+  sec.unlock();
+}
+
+TEST(TestFastSection, Contention)
+{
+  CFastSection sec;
+  long count = 0;
+  counter<CFastSection, CFastLock> c(sec, count, 100000);
+  runThreads(c, 8);
+  EXPECT_EQ(800000, count);
+}
+
+TEST(TestFastSharedSection, General)
+{
+  CFastSharedSection sec;
+
+  CFastSharedLock l1(sec);
+  CFastSharedLock l2(sec);
+  EXPECT_FALSE(sec.try_lock());
+  l1.Leave();
+  l2.Leave();
+  EXPECT_TRUE(sec.try_lock());
+  EXPECT_FALSE(sec.try_lock_shared());
+  sec.unlock();
+
+  CFastExclusiveLock l3(sec);
+  EXPECT_TRUE(l3.IsOwner());
+}
+
+TEST(TestFastSharedSection, ReadersAndWriters)
+{
+  CFastSharedSection sec;
+  readerWriter<CFastSharedSection> rw(sec, 100000);
+  runThreads(rw, 8);
+  EXPECT_EQ(0, rw.failures);
+}
+
+TEST(TestFastEvent, General)
+{
+  CFastEvent event;
+  EXPECT_FALSE(event.WaitMSec(0));
+  event.Set();
+  EXPECT_TRUE(event.Signaled());
+  EXPECT_TRUE(event.WaitMSec(0));
+  // auto reset
+  EXPECT_FALSE(event.Signaled());
+  EXPECT_FALSE(event.WaitMSec(10));
+
+  CFastEvent manual(true, true);
+  EXPECT_TRUE(manual.Wait());
+  EXPECT_TRUE(manual.WaitMSec(0));
+  manual.Reset();
+  EXPECT_FALSE(manual.WaitMSec(10));
+}
+
+TEST(TestFastEvent, PingPong)
+{
+  timePingPong<CFastEvent>(10000);
+}
+
+TEST(TestFastSection, DISABLED_Benchmark_Contention)
+{
+  const int iterations = 1000000;
+  for (int threads = 1; threads <= 16; threads *= 4)
+  {
+    std::cout << threads << " threads: CCriticalSection "
+              << timeContention<CCriticalSection, CSingleLock>(threads, iterations / threads) << "ms, CFastSection "
+              << timeContention<CFastSection, CFastLock>(threads, iterations / threads) << "ms" << std::endl;
+  }
+}
+
+TEST(TestFastSharedSection, DISABLED_Benchmark_Contention)
+{
+  const int iterations = 1000000;
+  for (int threads = 1; threads <= 16; threads *= 4)
+  {
+    CSharedSection sharedSection;
+    readerWriter<CSharedSection> shared(sharedSection, iterations / threads);
+    CStopWatch watch;
+    watch.StartZero();
+    runThreads(shared, threads);
+    const float sharedTime = watch.GetElapsedMilliseconds();
+
+    CFastSharedSection fastSection;
+    readerWriter<CFastSharedSection> fast(fastSection, iterations / threads);
+    watch.StartZero();
+    runThreads(fast, threads);
+    const float fastTime = watch.GetElapsedMilliseconds();
+
+    std::cout << threads << " threads: CSharedSection " << sharedTime
+              << "ms, CFastSharedSection " << fastTime << "ms" << std::endl;
+  }
+}
+
+TEST(TestFastEvent, DISABLED_Benchmark_PingPong)
+{
+  const int iterations = 100000;
+  std::cout << iterations << " round trips: CEvent " << timePingPong<CEvent>(iterations)
+            << "ms, CFastEvent " << timePingPong<CFastEvent>(iterations) << "ms" << std::endl;
+}
@@ -32,6 +32,8 @@
 
 #include <errno.h>
 #include <iconv.h>
+#include <stdint.h>
+#include <string.h>
 
 #if !defined(TARGET_WINDOWS) && defined(HAVE_CONFIG_H)
   #include "config.h"
@@ -48,6 +50,7 @@
   #define UTF16_CHARSET "UTF-16" ENDIAN_SUFFIX
   #define UTF32_CHARSET "UTF-32" ENDIAN_SUFFIX
   #define UTF8_SOURCE "UTF-8-MAC"
+  #define UTF8_SOURCE_NEEDS_ICONV 1 /* UTF-8-MAC composes decomposed sequences */
   #define WCHAR_CHARSET UTF32_CHARSET
 #elif defined(TARGET_WINDOWS)
   #define WCHAR_IS_UTF16 1
@@ -79,6 +82,10 @@
   #endif
 #endif
 
+#if defined(WCHAR_IS_UCS_4) || defined(WCHAR_IS_UTF16)
+  #define WCHAR_IS_UNICODE 1
+#endif
+
 #define NO_ICONV ((iconv_t)-1)
 
 enum SpecialCharset
@@ -333,6 +340,268 @@ CConverterType CCharsetConverter::CInnerConverter::m_stdConversion[NumberOfStdCo
 CCriticalSection CCharsetConverter::CInnerConverter::m_critSectionFriBiDi;
 
 
+/* Native conversions between UTF-8, UTF-16/UTF-32 and wchar_t. They are used instead of iconv
+   for the conversions done for every GUI label and tag, as they don't need to take the lock of
+   the converter. As with iconv, invalid input either fails the conversion or is skipped. */
+
+/* check whether the next sizeof(uint64_t) bytes are all US-ASCII */
+static inline bool isAsciiWord(const unsigned char* str)
+{
+  uint64_t word;
+  memcpy(&word, str, sizeof(word));
+  return (word & 0x8080808080808080ULL) == 0;
+}
+
+/* iconv is still required for the UTF-8 source on some platforms, except for plain US-ASCII */
+static inline bool utf8SourceNeedsIconv(const std::string& str)
+{
+#ifdef UTF8_SOURCE_NEEDS_ICONV
+  return CUtf8Utils::checkStrForUtf8(str) != CUtf8Utils::plainAscii;
+#else
+  return false;
+#endif
+}
+
+/* Decode the UTF-8 sequence at pos and advance pos past it. Overlong sequences, surrogates,
+   code points beyond U+10FFFF and truncated sequences are invalid, for these false is returned
+   and pos is only advanced past the first byte. */
+static inline bool decodeUtf8(const unsigned char* str, size_t len, size_t& pos, uint32_t& codePoint)
+{
+  const unsigned char lead = str[pos];
+  size_t trail;
+  if (lead < 0x80)
+  {
+    codePoint = lead;
+    pos++;
+    return true;
+  }
+  else if (lead >= 0xC2 && lead <= 0xDF)
+  {
+    trail = 1;
+    codePoint = lead & 0x1F;
+  }
+  else if (lead >= 0xE0 && lead <= 0xEF)
+  {
+    trail = 2;
+    codePoint = lead & 0x0F;
+  }
+  else if (lead >= 0xF0 && lead <= 0xF4)
+  {
+    trail = 3;
+    codePoint = lead & 0x07;
+  }
+  else
+  {
+    pos++;
+    return false;
+  }
+
+  if (len - pos <= trail)
+  {
+    pos++;
+    return false;
+  }
+
+  for (size_t i = 1; i <= trail; i++)
+  {
+    const unsigned char c = str[pos + i];
+    if ((c & 0xC0) != 0x80)
+    {
+      pos++;
+      return false;
+    }
+    codePoint = (codePoint << 6) | (c & 0x3F);
+  }
+
+  if ((trail == 2 && codePoint < 0x800) || (trail == 3 && codePoint < 0x10000) ||
+      codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+  {
+    pos++;
+    return false;
+  }
+
+  pos += trail + 1;
+  return true;
+}
+
+/* Decode the code point at pos of an UTF-16 or UTF-32 string and advance pos past it.
+   Unpaired surrogates and values beyond U+10FFFF are invalid and skipped. */
+template<class INPUT>
+static inline bool decodeUnicode(const INPUT& str, size_t& pos, uint32_t& codePoint)
+{
+  codePoint = (uint32_t)str[pos++];
+  if (sizeof(typename INPUT::value_type) == 2 && codePoint >= 0xD800 && codePoint <= 0xDBFF && pos < str.length())
+  {
+    const uint32_t low = (uint32_t)str[pos];
+    if (low >= 0xDC00 && low <= 0xDFFF)
+    {
+      pos++;
+      codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+      return true;
+    }
+  }
+
+  return codePoint <= 0x10FFFF && (codePoint < 0xD800 || codePoint > 0xDFFF);
+}
+
+template<typename UNIT>
+static inline UNIT* encodeUnicode(UNIT* out, uint32_t codePoint)
+{
+  if (sizeof(UNIT) == 2 && codePoint > 0xFFFF)
+  {
+    codePoint -= 0x10000;
+    *out++ = (UNIT)(0xD800 + (codePoint >> 10));
+    *out++ = (UNIT)(0xDC00 + (codePoint & 0x3FF));
+  }
+  else
+    *out++ = (UNIT)codePoint;
+
+  return out;
+}
+
+static inline size_t sizeOfUtf8(uint32_t codePoint)
+{
+  if (codePoint < 0x80)
+    return 1;
+  if (codePoint < 0x800)
+    return 2;
+  if (codePoint < 0x10000)
+    return 3;
+  return 4;
+}
+
+static inline char* encodeUtf8(char* out, uint32_t codePoint)
+{
+  if (codePoint < 0x80)
+    *out++ = (char)codePoint;
+  else if (codePoint < 0x800)
+  {
+    *out++ = (char)(0xC0 | (codePoint >> 6));
+    *out++ = (char)(0x80 | (codePoint & 0x3F));
+  }
+  else if (codePoint < 0x10000)
+  {
+    *out++ = (char)(0xE0 | (codePoint >> 12));
+    *out++ = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+    *out++ = (char)(0x80 | (codePoint & 0x3F));
+  }
+  else
+  {
+    *out++ = (char)(0xF0 | (codePoint >> 18));
+    *out++ = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+    *out++ = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+    *out++ = (char)(0x80 | (codePoint & 0x3F));
+  }
+
+  return out;
+}
+
+template<class OUTPUT>
+static bool utf8ToUnicode(const std::string& strSource, OUTPUT& strDest, bool failOnInvalidChar)
+{
+  typedef typename OUTPUT::value_type unit;
+
+  strDest.clear();
+  const size_t len = strSource.length();
+  if (len == 0)
+    return true;
+
+  // no UTF-8 sequence results in more UTF-16 or UTF-32 units than it has bytes
+  strDest.resize(len);
+  unit* const outStart = &strDest[0];
+  unit* out = outStart;
+
+  const unsigned char* const str = (const unsigned char*)strSource.data();
+  size_t pos = 0;
+  while (pos < len)
+  {
+    // US-ASCII is copied a machine word at a time
+    while (len - pos >= sizeof(uint64_t) && isAsciiWord(str + pos))
+    {
+      for (size_t i = 0; i < sizeof(uint64_t); i++)
+        out[i] = (unit)str[pos + i];
+      out += sizeof(uint64_t);
+      pos += sizeof(uint64_t);
+    }
+    if (pos >= len)
+      break;
+
+    uint32_t codePoint;
+    if (decodeUtf8(str, len, pos, codePoint))
+      out = encodeUnicode(out, codePoint);
+    else if (failOnInvalidChar)
+    {
+      strDest.clear();
+      return false;
+    }
+  }
+
+  strDest.resize(out - outStart);
+  return true;
+}
+
+template<class INPUT>
+static bool unicodeToUtf8(const INPUT& strSource, std::string& strDest, bool failOnInvalidChar)
+{
+  strDest.clear();
+  const size_t len = strSource.length();
+
+  // validate and size the output first, so that it is allocated exactly once
+  size_t outLen = 0;
+  uint32_t codePoint;
+  for (size_t pos = 0; pos < len; )
+  {
+    if (decodeUnicode(strSource, pos, codePoint))
+      outLen += sizeOfUtf8(codePoint);
+    else if (failOnInvalidChar)
+      return false;
+  }
+  if (outLen == 0)
+    return true;
+
+  strDest.resize(outLen);
+  char* out = &strDest[0];
+  for (size_t pos = 0; pos < len; )
+  {
+    if (decodeUnicode(strSource, pos, codePoint))
+      out = encodeUtf8(out, codePoint);
+  }
+
+  return true;
+}
+
+template<class INPUT, class OUTPUT>
+static bool unicodeToUnicode(const INPUT& strSource, OUTPUT& strDest, bool failOnInvalidChar)
+{
+  typedef typename OUTPUT::value_type unit;
+
+  strDest.clear();
+  const size_t len = strSource.length();
+  if (len == 0)
+    return true;
+
+  // only UTF-32 to UTF-16 may need more units, two at most
+  strDest.resize(sizeof(unit) < sizeof(typename INPUT::value_type) ? len * 2 : len);
+  unit* const outStart = &strDest[0];
+  unit* out = outStart;
+
+  uint32_t codePoint;
+  for (size_t pos = 0; pos < len; )
+  {
+    if (decodeUnicode(strSource, pos, codePoint))
+      out = encodeUnicode(out, codePoint);
+    else if (failOnInvalidChar)
+    {
+      strDest.clear();
+      return false;
+    }
+  }
+
+  strDest.resize(out - outStart);
+  return true;
+}
+
+
 
 template<class INPUT,class OUTPUT>
 bool CCharsetConverter::CInnerConverter::stdConvert(StdConversionType convertType, const INPUT& strSource, OUTPUT& strDest, bool failOnInvalidChar /*= false*/)
@@ -671,7 +940,10 @@ void CCharsetConverter::reinitCharsetsFromSettings(void)
 
 bool CCharsetConverter::utf8ToUtf32(const std::string& utf8StringSrc, std::u32string& utf32StringDst, bool failOnBadChar /*= true*/)
 {
-  return CInnerConverter::stdConvert(Utf8ToUtf32, utf8StringSrc, utf32StringDst, failOnBadChar);
+  if (utf8SourceNeedsIconv(utf8StringSrc))
+    return CInnerConverter::stdConvert(Utf8ToUtf32, utf8StringSrc, utf32StringDst, failOnBadChar);
+
+  return utf8ToUnicode(utf8StringSrc, utf32StringDst, failOnBadChar);
 }
 
 std::u32string CCharsetConverter::utf8ToUtf32(const std::string& utf8StringSrc, bool failOnBadChar /*= true*/)
@@ -686,17 +958,17 @@ bool CCharsetConverter::utf8ToUtf32Visual(const std::string& utf8StringSrc, std:
   if (bVisualBiDiFlip)
   {
     std::u32string converted;
-    if (!CInnerConverter::stdConvert(Utf8ToUtf32, utf8StringSrc, converted, failOnBadChar))
+    if (!utf8ToUtf32(utf8StringSrc, converted, failOnBadChar))
       return false;
 
     return CInnerConverter::logicalToVisualBiDi(converted, utf32StringDst, forceLTRReadingOrder ? FRIBIDI_TYPE_LTR : FRIBIDI_TYPE_PDF, failOnBadChar);
   }
-  return CInnerConverter::stdConvert(Utf8ToUtf32, utf8StringSrc, utf32StringDst, failOnBadChar);
+  return utf8ToUtf32(utf8StringSrc, utf32StringDst, failOnBadChar);
 }
 
 bool CCharsetConverter::utf32ToUtf8(const std::u32string& utf32StringSrc, std::string& utf8StringDst, bool failOnBadChar /*= true*/)
 {
-  return CInnerConverter::stdConvert(Utf32ToUtf8, utf32StringSrc, utf8StringDst, failOnBadChar);
+  return unicodeToUtf8(utf32StringSrc, utf8StringDst, failOnBadChar);
 }
 
 std::string CCharsetConverter::utf32ToUtf8(const std::u32string& utf32StringSrc, bool failOnBadChar /*= false*/)
@@ -711,6 +983,8 @@ bool CCharsetConverter::utf32ToW(const std::u32string& utf32StringSrc, std::wstr
 #ifdef WCHAR_IS_UCS_4
   wStringDst.assign((const wchar_t*)utf32StringSrc.c_str(), utf32StringSrc.length());
   return true;
+#elif defined(WCHAR_IS_UTF16)
+  return unicodeToUnicode(utf32StringSrc, wStringDst, failOnBadChar);
 #else // !WCHAR_IS_UCS_4
   return CInnerConverter::stdConvert(Utf32ToW, utf32StringSrc, wStringDst, failOnBadChar);
 #endif // !WCHAR_IS_UCS_4
@@ -727,7 +1001,11 @@ bool CCharsetConverter::wToUtf32(const std::wstring& wStringSrc, std::u32string&
   /* UCS-4 is almost equal to UTF-32, but UTF-32 has strict limits on possible values, while UCS-4 is usually unchecked.
    * With this "conversion" we ensure that output will be valid UTF-32 string. */
 #endif
+#ifdef WCHAR_IS_UNICODE
+  return unicodeToUnicode(wStringSrc, utf32StringDst, failOnBadChar);
+#else // !WCHAR_IS_UNICODE
   return CInnerConverter::stdConvert(WToUtf32, wStringSrc, utf32StringDst, failOnBadChar);
+#endif // !WCHAR_IS_UNICODE
 }
 
 // The bVisualBiDiFlip forces a flip of characters for hebrew/arabic languages, only set to false if the flipping
@@ -740,15 +1018,19 @@ bool CCharsetConverter::utf8ToW(const std::string& utf8StringSrc, std::wstring&
   {
     wStringDst.clear();
     std::u32string utf32str;
-    if (!CInnerConverter::stdConvert(Utf8ToUtf32, utf8StringSrc, utf32str, failOnBadChar))
+    if (!utf8ToUtf32(utf8StringSrc, utf32str, failOnBadChar))
       return false;
 
     std::u32string utf32flipped;
     const bool bidiResult = CInnerConverter::logicalToVisualBiDi(utf32str, utf32flipped, forceLTRReadingOrder ? FRIBIDI_TYPE_LTR : FRIBIDI_TYPE_PDF, failOnBadChar);
 
-    return CInnerConverter::stdConvert(Utf32ToW, utf32flipped, wStringDst, failOnBadChar) && bidiResult;
+    return utf32ToW(utf32flipped, wStringDst, failOnBadChar) && bidiResult;
   }
-  
+
+#ifdef WCHAR_IS_UNICODE
+  if (!utf8SourceNeedsIconv(utf8StringSrc))
+    return utf8ToUnicode(utf8StringSrc, wStringDst, failOnBadChar);
+#endif // WCHAR_IS_UNICODE
   return CInnerConverter::stdConvert(Utf8toW, utf8StringSrc, wStringDst, failOnBadChar);
 }
 
@@ -831,7 +1113,11 @@ bool CCharsetConverter::unknownToUTF8(const std::string& stringSrc, std::string&
 
 bool CCharsetConverter::wToUTF8(const std::wstring& wStringSrc, std::string& utf8StringDst, bool failOnBadChar /*= false*/)
 {
+#ifdef WCHAR_IS_UNICODE
+  return unicodeToUtf8(wStringSrc, utf8StringDst, failOnBadChar);
+#else // !WCHAR_IS_UNICODE
   return CInnerConverter::stdConvert(WtoUtf8, wStringSrc, utf8StringDst, failOnBadChar);
+#endif // !WCHAR_IS_UNICODE
 }
 
 bool CCharsetConverter::utf16BEtoUTF8(const std::u16string& utf16StringSrc, std::string& utf8StringDst)
@@ -878,7 +1164,7 @@ bool CCharsetConverter::utf8logicalToVisualBiDi(const std::string& utf8StringSrc
   if (!utf8ToUtf32Visual(utf8StringSrc, utf32flipped, true, true, failOnBadString))
     return false;
 
-  return CInnerConverter::stdConvert(Utf32ToUtf8, utf32flipped, utf8StringDst, failOnBadString);
+  return utf32ToUtf8(utf32flipped, utf8StringDst, failOnBadString);
 }
 
 void CCharsetConverter::SettingOptionsCharsetsFiller(const CSetting* setting, std::vector< std::pair<std::string, std::string> >& list, std::string& current, void *data)
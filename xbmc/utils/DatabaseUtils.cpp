@@ -360,13 +360,15 @@ bool DatabaseUtils::GetDatabaseResults(const MediaType &mediaType, const FieldLi
   const dbiplus::result_set &resultSet = dataset->get_result_set();
   unsigned int offset = results.size();
 
+  // every row is built in place in the results, as copying a row means copying every node
+  // of its map and every string in it
   if (fields.empty())
   {
-    DatabaseResult result;
+    results.reserve(resultSet.records.size() + offset);
     for (unsigned int index = 0; index < resultSet.records.size(); index++)
     {
-      result[FieldRow] = index + offset;
-      results.push_back(result);
+      results.push_back(DatabaseResult());
+      results.back().insert(results.back().end(), std::make_pair(FieldRow, CVariant(index + offset)));
     }
 
     return true;
@@ -378,39 +380,46 @@ bool DatabaseUtils::GetDatabaseResults(const MediaType &mediaType, const FieldLi
   std::vector<int> fieldIndexLookup;
   fieldIndexLookup.reserve(fields.size());
   for (FieldList::const_iterator it = fields.begin(); it != fields.end(); ++it)
-    fieldIndexLookup.push_back(GetFieldIndex(*it, mediaType));
+  {
+    int fieldIndex = GetFieldIndex(*it, mediaType);
+    if (fieldIndex < 0)
+      return false;
+    fieldIndexLookup.push_back(fieldIndex);
+  }
 
   results.reserve(resultSet.records.size() + offset);
   for (unsigned int index = 0; index < resultSet.records.size(); index++)
   {
-    DatabaseResult result;
+    results.push_back(DatabaseResult());
+    DatabaseResult &result = results.back();
     result[FieldRow] = index + offset;
 
     unsigned int lookupIndex = 0;
     for (FieldList::const_iterator it = fields.begin(); it != fields.end(); ++it)
     {
       int fieldIndex = fieldIndexLookup[lookupIndex++];
-      if (fieldIndex < 0)
-        return false;
 
-      std::pair<Field, CVariant> value;
-      value.first = *it;
-      if (!GetFieldValue(resultSet.records[index]->at(fieldIndex), value.second))
+      // only insert the field if it's not there yet, the same as inserting a pair. The value
+      // starts out as a plain null, as a const null can't be assigned to
+      std::pair<DatabaseResult::iterator, bool> inserted = result.insert(std::make_pair(*it, CVariant()));
+      if (!inserted.second)
+        continue;
+
+      CVariant &value = inserted.first->second;
+      if (!GetFieldValue(resultSet.records[index]->at(fieldIndex), value))
         CLog::Log(LOGWARNING, "GetDatabaseResults: unable to retrieve value of field %s", resultSet.record_header[fieldIndex].name.c_str());
 
-      if (value.first == FieldYear &&
+      if (*it == FieldYear &&
          (mediaType == MediaTypeTvShow || mediaType == MediaTypeEpisode))
       {
         CDateTime dateTime;
-        dateTime.SetFromDBDate(value.second.asString());
+        dateTime.SetFromDBDate(value.asString());
         if (dateTime.IsValid())
         {
-          value.second.clear();
-          value.second = dateTime.GetYear();
+          value.clear();
+          value = dateTime.GetYear();
         }
       }
-
-      result.insert(value);
     }
 
     result[FieldMediaType] = mediaType;
@@ -418,27 +427,13 @@ bool DatabaseUtils::GetDatabaseResults(const MediaType &mediaType, const FieldLi
         mediaType == MediaTypeTvShow || mediaType == MediaTypeMusicVideo)
       result[FieldLabel] = result.at(FieldTitle).asString();
     else if (mediaType == MediaTypeEpisode)
-    {
-      std::ostringstream label;
-      label << (int)(result.at(FieldSeason).asInteger() * 100 + result.at(FieldEpisodeNumber).asInteger());
-      label << ". ";
-      label << result.at(FieldTitle).asString();
-      result[FieldLabel] = label.str();
-    }
+      result[FieldLabel] = StringUtils::Format("%i. %s", (int)(result.at(FieldSeason).asInteger() * 100 + result.at(FieldEpisodeNumber).asInteger()), result.at(FieldTitle).asString().c_str());
     else if (mediaType == MediaTypeAlbum)
       result[FieldLabel] = result.at(FieldAlbum).asString();
     else if (mediaType == MediaTypeSong)
-    {
-      std::ostringstream label;
-      label << (int)result.at(FieldTrackNumber).asInteger();
-      label << ". ";
-      label << result.at(FieldTitle).asString();
-      result[FieldLabel] = label.str();
-    }
+      result[FieldLabel] = StringUtils::Format("%i. %s", (int)result.at(FieldTrackNumber).asInteger(), result.at(FieldTitle).asString().c_str());
     else if (mediaType == MediaTypeArtist)
       result[FieldLabel] = result.at(FieldArtist).asString();
-
-    results.push_back(result);
   }
 
   return true;
@@ -26,7 +26,6 @@
 
 #include "system.h"
 
-
 using namespace std;
 
 bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
@@ -166,6 +165,18 @@ bool CJobQueue::QueueEmpty() const
   return m_jobQueue.empty();
 }
 
+unsigned int CJobQueue::QueueSize() const
+{
+  CSingleLock lock(m_section);
+  return m_jobQueue.size();
+}
+
+unsigned int CJobQueue::ProcessingSize() const
+{
+  CSingleLock lock(m_section);
+  return m_processing.size();
+}
+
 CJobManager &CJobManager::GetInstance()
 {
   static CJobManager sJobManager;
@@ -177,6 +188,7 @@ CJobManager::CJobManager()
   m_jobCounter = 0;
   m_running = true;
   m_pauseJobs = false;
+  memset(m_latencies, 0, sizeof(m_latencies));
 }
 
 void CJobManager::Restart()
@@ -199,6 +211,7 @@ void CJobManager::CancelJobs()
     for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
     m_jobQueue[priority].clear();
   }
+  m_queuedJobs.clear();
 
   // cancel any callbacks on jobs still processing
   for_each(m_processing.begin(), m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
@@ -229,9 +242,11 @@ unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORI
   if (m_jobCounter == 0)
     m_jobCounter++;
 
-  // create a work item for this job
+  // create a work item for this job. Items are only ever added to the back and taken from the
+  // front of the queue, so the pointer to the item stays valid while it's queued.
   CWorkItem work(job, m_jobCounter, priority, callback);
   m_jobQueue[priority].push_back(work);
+  m_queuedJobs[work.m_id] = &m_jobQueue[priority].back();
 
   StartWorkers(priority);
   return work.m_id;
@@ -241,16 +256,14 @@ void CJobManager::CancelJob(unsigned int jobID)
 {
   CSingleLock lock(m_section);
 
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  // check whether we have this job in the queue. Its item is left in the queue without
+  // a job, and is dropped once it reaches the front.
+  QueuedJobs::iterator i = m_queuedJobs.find(jobID);
+  if (i != m_queuedJobs.end())
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
-    {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
-      return;
-    }
+    i->second->FreeJob();
+    m_queuedJobs.erase(i);
+    return;
   }
   // or if we're processing it
   Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
@@ -280,25 +293,78 @@ void CJobManager::StartWorkers(CJob::PRIORITY priority)
 CJob *CJobManager::PopJob()
 {
   CSingleLock lock(m_section);
+  const unsigned int now = XbmcThreads::SystemClockMillis();
+  int best = -1;
+  unsigned int bestWaited = 0;
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
   {
     // Check whether we're pausing pausable jobs
     if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    // drop cancelled jobs
+    JobQueue &queue = m_jobQueue[priority];
+    while (!queue.empty() && !queue.front().m_job)
+      queue.pop_front();
+    if (queue.empty())
+      continue;
+
+    // the front job has been queued the longest. An aged job may use the workers of its
+    // effective priority, which is how it gets to run next to a steady stream of higher
+    // priority jobs. Aging stops below PRIORITY_HIGH, so the worker kept free for high
+    // priority jobs stays free.
+    const unsigned int waited = now - queue.front().m_queued;
+    if (m_processing.size() >= GetMaxWorkers(GetEffectivePriority(CJob::PRIORITY(priority), waited)))
+      continue;
+
+    if (best < 0 || IsPreferred(CJob::PRIORITY(priority), waited, CJob::PRIORITY(best), bestWaited))
     {
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
+      best = priority;
+      bestWaited = waited;
     }
   }
-  return NULL;
+
+  if (best < 0)
+    return NULL;
+
+  // pop the job off the queue
+  CWorkItem job = m_jobQueue[best].front();
+  m_jobQueue[best].pop_front();
+  m_queuedJobs.erase(job.m_id);
+
+  unsigned int bucket = 0;
+  while (bucket < LATENCY_BUCKETS - 1 && bestWaited >= (1U << bucket))
+    bucket++;
+  m_latencies[best][bucket]++;
+
+  // add to the processing vector
+  m_processing.push_back(job);
+  job.m_job->m_callback = this;
+  return job.m_job;
+}
+
+CJob::PRIORITY CJobManager::GetEffectivePriority(CJob::PRIORITY priority, unsigned int waited)
+{
+  if (priority >= CJob::PRIORITY_NORMAL)
+    return priority;
+  unsigned int effective = priority + waited / AGING_INTERVAL;
+  return CJob::PRIORITY(std::min<unsigned int>(effective, CJob::PRIORITY_NORMAL));
+}
+
+bool CJobManager::IsPreferred(CJob::PRIORITY priority, unsigned int waited, CJob::PRIORITY otherPriority, unsigned int otherWaited)
+{
+  CJob::PRIORITY effective = GetEffectivePriority(priority, waited);
+  CJob::PRIORITY otherEffective = GetEffectivePriority(otherPriority, otherWaited);
+  if (effective != otherEffective)
+    return effective > otherEffective;
+
+  // of the same effective priority, the job that has been there longest goes first, with an
+  // aged job only counting the time since it got there
+  const unsigned int aged = waited - (effective - priority) * AGING_INTERVAL;
+  const unsigned int otherAged = otherWaited - (otherEffective - otherPriority) * AGING_INTERVAL;
+  if (aged != otherAged)
+    return aged > otherAged;
+  return priority > otherPriority;
 }
 
 void CJobManager::PauseJobs()
@@ -328,6 +394,12 @@ bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
   return false;
 }
 
+void CJobManager::GetQueueLatencies(CJob::PRIORITY priority, std::vector<unsigned int> &buckets) const
+{
+  CSingleLock lock(m_section);
+  buckets.assign(m_latencies[priority], m_latencies[priority] + LATENCY_BUCKETS);
+}
+
 int CJobManager::IsProcessing(const std::string &type) const
 {
   int jobsMatched = 0;
@@ -19,10 +19,12 @@
  *
  */
 
+#include <map>
 #include <queue>
 #include <vector>
 #include <string>
 #include "threads/CriticalSection.h"
+#include "threads/SystemClock.h"
 #include "threads/Thread.h"
 #include "Job.h"
 
@@ -141,7 +143,19 @@ protected:
    NOTE: This function does not take into account the jobs that are currently processing 
    */
   bool QueueEmpty() const;
-  
+
+  /*!
+   \brief Returns the number of jobs waiting to be processed
+   \sa ProcessingSize()
+   */
+  unsigned int QueueSize() const;
+
+  /*!
+   \brief Returns the number of jobs from this queue currently being processed
+   \sa QueueSize()
+   */
+  unsigned int ProcessingSize() const;
+
 private:
   void QueueNextJob();
 
@@ -178,6 +192,7 @@ class CJobManager
       m_id = id;
       m_callback = callback;
       m_priority = priority;
+      m_queued = XbmcThreads::SystemClockMillis();
     }
     bool operator==(unsigned int jobID) const
     {
@@ -200,6 +215,7 @@ class CJobManager
     unsigned int  m_id;
     IJobCallback *m_callback;
     CJob::PRIORITY m_priority;
+    unsigned int  m_queued; ///< \brief time the job was added to the queue, in ms
   };
 
 public:
@@ -269,9 +285,22 @@ public:
    */
   bool IsProcessing(const CJob::PRIORITY &priority) const;
 
+  /*!
+   \brief Get a histogram of how long jobs of a priority waited in the queue before being processed.
+   \param priority the priority of the jobs
+   \param buckets the histogram. The first bucket counts the jobs that waited less than 1ms, each
+   following bucket those that waited less than twice as long, and the last one all longer waits.
+   \sa LATENCY_BUCKETS
+   */
+  void GetQueueLatencies(CJob::PRIORITY priority, std::vector<unsigned int> &buckets) const;
+
+  enum { LATENCY_BUCKETS = 16 }; ///< \brief number of buckets of the queue latency histograms
+  enum { AGING_INTERVAL = 5000 }; ///< \brief ms a queued job waits for each step up in effective priority
+
 protected:
   friend class CJobWorker;
   friend class CJob;
+  friend class TestJobManagerHelper;
 
   /*!
    \brief Get a new job to process. Blocks until a new job is available, or a timeout has occurred.
@@ -308,10 +337,33 @@ private:
   virtual ~CJobManager();
 
   /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+   A job is only taken while fewer workers than the maximum for its effective priority are busy.
    \return the job to process, NULL if no jobs are available
+   \sa IsPreferred
    */
   CJob *PopJob();
 
+  /*! \brief Get the priority a queued job is taken as having
+   Jobs rise a priority for every AGING_INTERVAL ms they've been queued, up to PRIORITY_NORMAL.
+   \param priority the priority the job was queued with
+   \param waited how long the job has been queued, in ms
+   \return the effective priority of the job
+   */
+  static CJob::PRIORITY GetEffectivePriority(CJob::PRIORITY priority, unsigned int waited);
+
+  /*! \brief Check whether a queued job should be processed before another
+   Jobs are ordered by their effective priority, then by how long they've had it. So a job
+   queued with PRIORITY_LOW counts as a PRIORITY_NORMAL job queued AGING_INTERVAL ms later,
+   and overtakes normal priority jobs that were queued after that.
+   \param priority the priority the job was queued with
+   \param waited how long the job has been queued, in ms
+   \param otherPriority the priority the other job was queued with
+   \param otherWaited how long the other job has been queued, in ms
+   \return true if the job goes first, false otherwise
+   \sa GetEffectivePriority
+   */
+  static bool IsPreferred(CJob::PRIORITY priority, unsigned int waited, CJob::PRIORITY otherPriority, unsigned int otherWaited);
+
   void StartWorkers(CJob::PRIORITY priority);
   void RemoveWorker(const CJobWorker *worker);
   static unsigned int GetMaxWorkers(CJob::PRIORITY priority);
@@ -321,8 +373,11 @@ private:
   typedef std::deque<CWorkItem>    JobQueue;
   typedef std::vector<CWorkItem>   Processing;
   typedef std::vector<CJobWorker*> Workers;
+  typedef std::map<unsigned int, CWorkItem*> QueuedJobs;
 
   JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
+  QueuedJobs m_queuedJobs; ///< \brief queued work items by id. Cancelled items are left in the queues without a job.
+  unsigned int m_latencies[CJob::PRIORITY_HIGH+1][LATENCY_BUCKETS];
   bool       m_pauseJobs;
   Processing m_processing;
   Workers    m_workers;
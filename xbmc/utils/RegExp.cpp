@@ -26,6 +26,12 @@
 #include "log.h"
 #include "utils/StringUtils.h"
 #include "utils/Utf8Utils.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/ThreadLocal.h"
+
+#include <map>
+#include <vector>
 
 using namespace PCRE;
 
@@ -52,6 +58,173 @@ int CRegExp::m_Utf8Supported = -1;
 int CRegExp::m_UcpSupported  = -1;
 int CRegExp::m_JitSupported  = -1;
 
+// maximum number of compiled expressions kept in the cache
+#define REGEXP_CACHE_SIZE 256
+
+/*! \brief A compiled (and studied) expression, shared by all CRegExp objects compiled
+ from the same expression with the same options. It is never modified once created.
+ */
+struct CRegExpPattern
+{
+  CRegExpPattern(pcre* re, pcre_extra* sd, bool jitCompiled) : m_re(re), m_sd(sd), m_jitCompiled(jitCompiled) {}
+  ~CRegExpPattern()
+  {
+    if (m_sd)
+      pcre_free_study(m_sd);
+    pcre_free(m_re);
+  }
+
+  pcre* const       m_re;
+  pcre_extra* const m_sd;
+  const bool        m_jitCompiled;
+
+private:
+  CRegExpPattern(const CRegExpPattern&);
+  CRegExpPattern& operator=(const CRegExpPattern&);
+};
+
+typedef boost::shared_ptr<const CRegExpPattern> CRegExpPatternPtr;
+typedef std::pair<std::string, std::pair<int, int> > CRegExpPatternKey; // expression, options and study mode
+typedef std::map<CRegExpPatternKey, CRegExpPatternPtr> CRegExpPatternCache;
+
+static CRegExpPatternCache regExpCache;
+static CCriticalSection    regExpCacheSection;
+
+#ifdef PCRE_HAS_JIT_CODE
+// JIT compiled expressions are shared between threads, so a JIT stack can't be assigned to the
+// expression. Instead each match borrows a stack from a small pool, and PCRE finds it through the
+// thread local that is set for the time of the match.
+#define MAX_POOLED_JIT_STACKS 4
+
+class CRegExpJitStackPool
+{
+public:
+  ~CRegExpJitStackPool()
+  {
+    for (std::vector<pcre_jit_stack*>::iterator it = m_stacks.begin(); it != m_stacks.end(); ++it)
+      pcre_jit_stack_free(*it);
+  }
+
+  pcre_jit_stack* Borrow()
+  {
+    {
+      CSingleLock lock(m_section);
+      if (!m_stacks.empty())
+      {
+        pcre_jit_stack *stack = m_stacks.back();
+        m_stacks.pop_back();
+        return stack;
+      }
+    }
+
+    pcre_jit_stack *stack = pcre_jit_stack_alloc(32*1024, 512*1024);
+    if (stack == NULL)
+      CLog::Log(LOGWARNING, "%s: can't allocate address space for JIT stack", __FUNCTION__);
+    return stack;
+  }
+
+  void Return(pcre_jit_stack *stack)
+  {
+    {
+      CSingleLock lock(m_section);
+      if (m_stacks.size() < MAX_POOLED_JIT_STACKS)
+      {
+        m_stacks.push_back(stack);
+        return;
+      }
+    }
+    pcre_jit_stack_free(stack);
+  }
+
+private:
+  CCriticalSection m_section;
+  std::vector<pcre_jit_stack*> m_stacks;
+};
+
+static CRegExpJitStackPool regExpJitStacks;
+static XbmcThreads::ThreadLocal<pcre_jit_stack> regExpJitStack;
+
+static pcre_jit_stack* GetJitStack(void* /*data*/)
+{
+  // if NULL is returned PCRE falls back to a small stack on the machine stack
+  return regExpJitStack.get();
+}
+#endif
+
+static CRegExpPatternPtr CompilePattern(const char *re, int options, CRegExp::studyMode study)
+{
+  const char *errMsg = NULL;
+  int errOffset      = 0;
+  pcre* compiled = pcre_compile(re, options, &errMsg, &errOffset, NULL);
+  if (!compiled)
+  {
+    CLog::Log(LOGERROR, "PCRE: %s. Compilation failed at offset %d in expression '%s'",
+              errMsg, errOffset, re);
+    return CRegExpPatternPtr();
+  }
+
+  pcre_extra* sd = NULL;
+  bool jitCompiled = false;
+  if (study)
+  {
+    const bool jitCompile = (study == CRegExp::StudyWithJitComp) && CRegExp::IsJitSupported();
+    const int studyOptions = jitCompile ? PCRE_STUDY_JIT_COMPILE : 0;
+
+    sd = pcre_study(compiled, studyOptions, &errMsg);
+    if (errMsg != NULL)
+    {
+      CLog::Log(LOGWARNING, "%s: PCRE error \"%s\" while studying expression", __FUNCTION__, errMsg);
+      if (sd != NULL)
+      {
+        pcre_free_study(sd);
+        sd = NULL;
+      }
+    }
+    else if (jitCompile)
+    {
+      int jitPresent = 0;
+      jitCompiled = (pcre_fullinfo(compiled, sd, PCRE_INFO_JIT, &jitPresent) == 0 && jitPresent == 1);
+#ifdef PCRE_HAS_JIT_CODE
+      if (jitCompiled)
+        pcre_assign_jit_stack(sd, GetJitStack, NULL);
+#endif
+    }
+  }
+
+  return CRegExpPatternPtr(new CRegExpPattern(compiled, sd, jitCompiled));
+}
+
+static CRegExpPatternPtr GetCachedPattern(const char *re, int options, CRegExp::studyMode study)
+{
+  const CRegExpPatternKey key(re, std::make_pair(options, (int)study));
+  CSingleLock lock(regExpCacheSection);
+  CRegExpPatternCache::const_iterator it = regExpCache.find(key);
+  if (it != regExpCache.end())
+    return it->second;
+  lock.Leave();
+
+  // compile outside of the lock, if another thread beats us to it we use its copy
+  CRegExpPatternPtr pattern = CompilePattern(re, options, study);
+  if (!pattern)
+    return pattern;
+
+  lock.Enter();
+  if (regExpCache.size() >= REGEXP_CACHE_SIZE)
+  {
+    // make room by dropping the expressions no CRegExp object is using
+    for (CRegExpPatternCache::iterator i = regExpCache.begin(); i != regExpCache.end(); )
+    {
+      if (i->second.unique())
+        regExpCache.erase(i++);
+      else
+        ++i;
+    }
+    if (regExpCache.size() >= REGEXP_CACHE_SIZE)
+      return pattern;
+  }
+  return regExpCache.insert(std::make_pair(key, pattern)).first->second;
+}
+
 
 CRegExp::CRegExp(bool caseless /*= false*/, CRegExp::utf8Mode utf8 /*= asciiOnly*/)
 {
@@ -78,7 +251,6 @@ void CRegExp::InitValues(bool caseless /*= false*/, CRegExp::utf8Mode utf8 /*= a
   m_jitCompiled = false;
   m_bMatched    = false;
   m_iMatchCount = 0;
-  m_jitStack    = NULL;
 
   memset(m_iOvector, 0, sizeof(m_iOvector));
 }
@@ -237,7 +409,6 @@ CRegExp::CRegExp(const CRegExp& re)
 {
   m_re = NULL;
   m_sd = NULL;
-  m_jitStack = NULL;
   m_utf8Mode = re.m_utf8Mode;
   m_iOptions = re.m_iOptions;
   *this = re;
@@ -245,27 +416,25 @@ CRegExp::CRegExp(const CRegExp& re)
 
 CRegExp& CRegExp::operator=(const CRegExp& re)
 {
-  size_t size;
+  if (this == &re)
+    return *this;
+
   Cleanup();
   m_jitCompiled = false;
   m_pattern = re.m_pattern;
-  if (re.m_re)
+  if (re.m_compiled)
   {
-    if (pcre_fullinfo(re.m_re, NULL, PCRE_INFO_SIZE, &size) >= 0)
-    {
-      if ((m_re = (pcre*)malloc(size)))
-      {
-        memcpy(m_re, re.m_re, size);
-        memcpy(m_iOvector, re.m_iOvector, OVECCOUNT*sizeof(int));
-        m_offset = re.m_offset;
-        m_iMatchCount = re.m_iMatchCount;
-        m_bMatched = re.m_bMatched;
-        m_subject = re.m_subject;
-        m_iOptions = re.m_iOptions;
-      }
-      else
-        CLog::Log(LOGSEVERE, "%s: Failed to allocate memory", __FUNCTION__);
-    }
+    // the compiled expression is shared, only the match state is copied
+    m_compiled = re.m_compiled;
+    m_re = m_compiled->m_re;
+    m_sd = m_compiled->m_sd;
+    m_jitCompiled = m_compiled->m_jitCompiled;
+    memcpy(m_iOvector, re.m_iOvector, OVECCOUNT*sizeof(int));
+    m_offset = re.m_offset;
+    m_iMatchCount = re.m_iMatchCount;
+    m_bMatched = re.m_bMatched;
+    m_subject = re.m_subject;
+    m_iOptions = re.m_iOptions;
   }
   return *this;
 }
@@ -284,47 +453,24 @@ bool CRegExp::RegComp(const char *re, studyMode study /*= NoStudy*/)
   m_jitCompiled      = false;
   m_bMatched         = false;
   m_iMatchCount      = 0;
-  const char *errMsg = NULL;
-  int errOffset      = 0;
   int options        = m_iOptions;
   if (m_utf8Mode == autoUtf8 && requireUtf8(re))
     options |= (IsUtf8Supported() ? PCRE_UTF8 : 0) | (AreUnicodePropertiesSupported() ? PCRE_UCP : 0);
 
   Cleanup();
 
-  m_re = pcre_compile(re, options, &errMsg, &errOffset, NULL);
-  if (!m_re)
+  m_compiled = GetCachedPattern(re, options, study);
+  if (!m_compiled)
   {
     m_pattern.clear();
-    CLog::Log(LOGERROR, "PCRE: %s. Compilation failed at offset %d in expression '%s'",
-              errMsg, errOffset, re);
     return false;
   }
 
+  m_re = m_compiled->m_re;
+  m_sd = m_compiled->m_sd;
+  m_jitCompiled = m_compiled->m_jitCompiled;
   m_pattern = re;
 
-  if (study)
-  {
-    const bool jitCompile = (study == StudyWithJitComp) && IsJitSupported();
-    const int studyOptions = jitCompile ? PCRE_STUDY_JIT_COMPILE : 0;
-
-    m_sd = pcre_study(m_re, studyOptions, &errMsg);
-    if (errMsg != NULL)
-    {
-      CLog::Log(LOGWARNING, "%s: PCRE error \"%s\" while studying expression", __FUNCTION__, errMsg);
-      if (m_sd != NULL)
-      {
-        pcre_free_study(m_sd);
-        m_sd = NULL;
-      }
-    }
-    else if (jitCompile)
-    {
-      int jitPresent = 0;
-      m_jitCompiled = (pcre_fullinfo(m_re, m_sd, PCRE_INFO_JIT, &jitPresent) == 0 && jitPresent == 1);
-    }
-  }
-
   return true;
 }
 
@@ -357,22 +503,22 @@ int CRegExp::PrivateRegFind(size_t bufferLen, const char *str, unsigned int star
     return -1;
   }
 
-#ifdef PCRE_HAS_JIT_CODE
-  if (m_jitCompiled && !m_jitStack)
-  {
-    m_jitStack = pcre_jit_stack_alloc(32*1024, 512*1024);
-    if (m_jitStack == NULL)
-      CLog::Log(LOGWARNING, "%s: can't allocate address space for JIT stack", __FUNCTION__);
-
-    pcre_assign_jit_stack(m_sd, NULL, m_jitStack);
-  }
-#endif
-
   if (maxNumberOfCharsToTest >= 0)
     bufferLen = std::min<size_t>(bufferLen, startoffset + maxNumberOfCharsToTest);
 
   m_subject.assign(str + startoffset, bufferLen - startoffset);
-  int rc = pcre_exec(m_re, NULL, m_subject.c_str(), m_subject.length(), 0, 0, m_iOvector, OVECCOUNT);
+#ifdef PCRE_HAS_JIT_CODE
+  pcre_jit_stack *jitStack = m_jitCompiled ? regExpJitStacks.Borrow() : NULL;
+  regExpJitStack.set(jitStack);
+#endif
+  int rc = pcre_exec(m_re, m_sd, m_subject.c_str(), m_subject.length(), 0, 0, m_iOvector, OVECCOUNT);
+#ifdef PCRE_HAS_JIT_CODE
+  if (jitStack)
+  {
+    regExpJitStack.set(NULL);
+    regExpJitStacks.Return(jitStack);
+  }
+#endif
 
   if (rc<1)
   {
@@ -558,25 +704,10 @@ void CRegExp::DumpOvector(int iLog /* = LOGDEBUG */)
 
 void CRegExp::Cleanup()
 {
-  if (m_re)
-  {
-    pcre_free(m_re); 
-    m_re = NULL; 
-  }
-
-  if (m_sd)
-  {
-    pcre_free_study(m_sd);
-    m_sd = NULL;
-  }
-
-#ifdef PCRE_HAS_JIT_CODE
-  if (m_jitStack)
-  {
-    pcre_jit_stack_free(m_jitStack);
-    m_jitStack = NULL;
-  }
-#endif
+  // the compiled expression is freed with the last CRegExp using it, or by the cache
+  m_compiled.reset();
+  m_re = NULL;
+  m_sd = NULL;
 }
 
 inline bool CRegExp::IsValidSubNumber(int iSub) const
@@ -24,6 +24,7 @@
 
 #include <string>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 namespace PCRE {
 struct real_pcre_jit_stack; // forward declaration for PCRE without JIT
@@ -39,6 +40,16 @@ typedef struct real_pcre_jit_stack pcre_jit_stack;
 #include <pcre.h>
 }
 
+struct CRegExpPattern;
+
+/**
+ * Regular expression matching with PCRE
+ *
+ * Compiled expressions are cached process wide by expression, options and study mode, and
+ * are shared by all CRegExp objects using them. A CRegExp object holds the state of its
+ * last match, so a single object must not be used by several threads at once, but any
+ * number of objects compiled from the same expression can be used concurrently.
+ */
 class CRegExp
 {
 public:
@@ -158,6 +169,7 @@ private:
   void Cleanup();
   inline bool IsValidSubNumber(int iSub) const;
 
+  boost::shared_ptr<const CRegExpPattern> m_compiled;
   PCRE::pcre* m_re;
   PCRE::pcre_extra* m_sd;
   static const int OVECCOUNT=(m_MaxNumOfBackrefrences + 1) * 3;
@@ -168,7 +180,6 @@ private:
   int         m_iOptions;
   bool        m_jitCompiled;
   bool        m_bMatched;
-  PCRE::pcre_jit_stack* m_jitStack;
   std::string m_subject;
   std::string m_pattern;
   static int  m_Utf8Supported;
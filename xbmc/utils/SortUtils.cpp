@@ -28,6 +28,8 @@
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
+#include <algorithm>
+
 using namespace std;
 
 string ArrayToString(SortAttribute attributes, const CVariant &variant, const string &seperator = " / ")
@@ -378,130 +380,123 @@ string ByDateTaken(SortAttribute attributes, const SortItem &values)
   return values.at(FieldDateTaken).asString();
 }
 
-bool preliminarySort(const SortItem &left, const SortItem &right, bool handleFolder, bool &result, std::wstring &labelLeft, std::wstring &labelRight)
+/*! \brief Everything the comparison of two items needs, extracted from the item once before sorting
+ */
+typedef struct
 {
-  // make sure both items have the necessary data to do the sorting
-  SortItem::const_iterator itLeftSort, itRightSort;
-  if ((itLeftSort = left.find(FieldSort)) == left.end())
-  {
-    result = false;
-    return true;
-  }
-  if ((itRightSort = right.find(FieldSort)) == right.end())
-  {
-    result = true;
-    return true;
-  }
+  size_t       index;   ///< position of the item before sorting, used to keep the sort stable
+  SortSpecial  special;
+  int          folder;  ///< 1 for folders, 0 for files, -1 if unknown
+  std::wstring label;
+} SortKey;
 
-  // look at special sorting behaviour
-  SortItem::const_iterator itLeft, itRight;
-  SortSpecial leftSortSpecial = SortSpecialNone;
-  SortSpecial rightSortSpecial = SortSpecialNone;
-  if ((itLeft = left.find(FieldSortSpecial)) != left.end() && itLeft->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    leftSortSpecial = (SortSpecial)itLeft->second.asInteger();
-  if ((itRight = right.find(FieldSortSpecial)) != right.end() && itRight->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    rightSortSpecial = (SortSpecial)itRight->second.asInteger();
-  
-  // one has a special sort
-  if (leftSortSpecial != rightSortSpecial)
+class SortKeyComparator
+{
+public:
+  SortKeyComparator(SortOrder sortOrder, SortAttribute attributes)
+    : m_descending(sortOrder == SortOrderDescending),
+      m_handleFolder((attributes & SortAttributeIgnoreFolders) == 0)
+  { }
+
+  bool operator()(const SortKey *left, const SortKey *right) const
   {
-    // left should be sorted on top
-    // or right should be sorted on bottom
-    // => left is sorted above right
-    if (leftSortSpecial == SortSpecialOnTop ||
-        rightSortSpecial == SortSpecialOnBottom)
+    // one has a special sort
+    if (left->special != right->special)
     {
-      result = true;
-      return true;
+      // left should be sorted on top
+      // or right should be sorted on bottom
+      // => left is sorted above right
+      // otherwise right is sorted above left
+      return left->special == SortSpecialOnTop || right->special == SortSpecialOnBottom;
     }
-    
-    // otherwise right is sorted above left
-    result = false;
-    return true;
-  }
-  // both have either sort on top or sort on bottom -> leave as-is
-  else if (leftSortSpecial != SortSpecialNone && leftSortSpecial == rightSortSpecial)
-  {
-    result = false;
-    return true;
-  }
 
-  if (handleFolder)
-  {
-    itLeft = left.find(FieldFolder);
-    itRight = right.find(FieldFolder);
-    if (itLeft != left.end() && itRight != right.end() &&
-        itLeft->second.asBoolean() != itRight->second.asBoolean())
+    // both have either sort on top or sort on bottom -> leave as-is
+    if (left->special == SortSpecialNone)
     {
-      result = itLeft->second.asBoolean();
-      return true;
+      if (m_handleFolder && left->folder >= 0 && right->folder >= 0 && left->folder != right->folder)
+        return left->folder == 1;
+
+      int64_t result = StringUtils::AlphaNumericCompare(left->label.c_str(), right->label.c_str());
+      if (result != 0)
+        return m_descending ? result > 0 : result < 0;
     }
-  }
 
-  labelLeft = itLeftSort->second.asWideString();
-  labelRight = itRightSort->second.asWideString();
+    // equal items keep their order
+    return left->index < right->index;
+  }
 
-  return false;
-}
+private:
+  bool m_descending;
+  bool m_handleFolder;
+};
 
-bool SorterAscending(const SortItem &left, const SortItem &right)
+void fillSortKey(SortKey &key, size_t index, const SortItem &item, const std::string &sortLabel)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+  key.index = index;
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+  SortItem::const_iterator it;
+  key.special = SortSpecialNone;
+  if ((it = item.find(FieldSortSpecial)) != item.end() && it->second.asInteger() <= (int64_t)SortSpecialOnBottom)
+    key.special = (SortSpecial)it->second.asInteger();
 
-bool SorterDescending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+  key.folder = -1;
+  if ((it = item.find(FieldFolder)) != item.end())
+    key.folder = it->second.asBoolean() ? 1 : 0;
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
+  g_charsetConverter.utf8ToW(sortLabel, key.label, false);
 }
 
-bool SorterIgnoreFoldersAscending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
-
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+SortItem &getSortItem(SortItem &item) { return item; }
+SortItem &getSortItem(SortItemPtr &item) { return *item; }
 
-bool SorterIgnoreFoldersDescending(const SortItem &left, const SortItem &right)
+/*! \brief Sort the given items
+ The keys are prepared once per item, so comparisons neither look up fields nor allocate. Only the
+ first sortedCount items are guaranteed to be in order (the rest being dropped by the limits anyway),
+ which allows a partial sort of large lists.
+ */
+template<class Items>
+void sortItems(SortUtils::SortPreparator preparator, const Fields &sortingFields, SortOrder sortOrder, SortAttribute attributes, Items &items, size_t sortedCount)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+  std::vector<SortKey> keys(items.size());
+  std::vector<const SortKey*> order(items.size());
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    SortItem &item = getSortItem(items[i]);
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
+    // add all fields to the item that are required for sorting if they are currently missing
+    for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
+    {
+      if (item.find(*field) == item.end())
+        item.insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
+    }
 
-bool SorterIndirectAscending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterAscending(*left, *right);
-}
+    // prepare the string used for sorting, and store it under FieldSort for our callers
+    fillSortKey(keys[i], i, item, preparator(attributes, item));
+    item[FieldSort] = CVariant(keys[i].label);
+    order[i] = &keys[i];
+  }
 
-bool SorterIndirectDescending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterDescending(*left, *right);
-}
+  SortKeyComparator comparator(sortOrder, attributes);
+  if (sortedCount < order.size())
+    std::partial_sort(order.begin(), order.begin() + sortedCount, order.end(), comparator);
+  else
+    std::sort(order.begin(), order.end(), comparator);
 
-bool SorterIndirectIgnoreFoldersAscending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterIgnoreFoldersAscending(*left, *right);
+  // move the items into their sorted positions
+  Items sorted(items.size());
+  for (size_t i = 0; i < order.size(); i++)
+    std::swap(sorted[i], items[order[i]->index]);
+  items.swap(sorted);
 }
 
-bool SorterIndirectIgnoreFoldersDescending(const SortItemPtr &left, const SortItemPtr &right)
+/*! \brief Number of items (from the front) which survive the given limits
+ */
+size_t getLimitedCount(size_t size, int limitEnd, int limitStart)
 {
-  return SorterIgnoreFoldersDescending(*left, *right);
+  if (limitEnd > 0 && (size_t)limitEnd < size &&
+     (limitStart <= 0 || (size_t)limitStart >= size || limitEnd > limitStart))
+    return limitEnd;
+  return size;
 }
 
 map<SortBy, SortUtils::SortPreparator> fillPreparators()
@@ -643,27 +638,7 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
     // get the matching SortPreparator
     SortPreparator preparator = getPreparator(sortBy);
     if (preparator != NULL)
-    {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
-
-      // Prepare the string used for sorting and store it under FieldSort
-      for (DatabaseResults::iterator item = items.begin(); item != items.end(); ++item)
-      {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
-        {
-          if (item->find(*field) == item->end())
-            item->insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        CStdStringW sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, *item), sortLabel, false);
-        item->insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
-      }
-
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
-    }
+      sortItems(preparator, GetFieldsForSorting(sortBy), sortOrder, attributes, items, getLimitedCount(items.size(), limitEnd, limitStart));
   }
 
   if (limitStart > 0 && (size_t)limitStart < items.size())
@@ -682,27 +657,7 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
     // get the matching SortPreparator
     SortPreparator preparator = getPreparator(sortBy);
     if (preparator != NULL)
-    {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
-
-      // Prepare the string used for sorting and store it under FieldSort
-      for (SortItems::iterator item = items.begin(); item != items.end(); ++item)
-      {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
-        {
-          if ((*item)->find(*field) == (*item)->end())
-            (*item)->insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        CStdStringW sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, **item), sortLabel, false);
-        (*item)->insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
-      }
-
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorterIndirect(sortOrder, attributes));
-    }
+      sortItems(preparator, GetFieldsForSorting(sortBy), sortOrder, attributes, items, getLimitedCount(items.size(), limitEnd, limitStart));
   }
 
   if (limitStart > 0 && (size_t)limitStart < items.size())
@@ -754,22 +709,6 @@ const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
   return m_preparators[SortByNone];
 }
 
-SortUtils::Sorter SortUtils::getSorter(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIgnoreFoldersDescending : SorterIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterDescending : SorterAscending;
-}
-
-SortUtils::SorterIndirect SortUtils::getSorterIndirect(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIndirectIgnoreFoldersDescending : SorterIndirectIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterIndirectDescending : SorterIndirectAscending;
-}
-
 const Fields& SortUtils::GetFieldsForSorting(SortBy sortBy)
 {
   map<SortBy, Fields>::const_iterator it = m_sortingFields.find(sortBy);
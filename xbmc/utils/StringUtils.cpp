@@ -774,7 +774,7 @@ int64_t StringUtils::AlphaNumericCompare(const wchar_t *left, const wchar_t *rig
       rc += L'a'- L'A';
 
     // ok, do a normal comparison, taking current locale into account. Add special case stuff (eg '(' characters)) in here later
-    if ((cmp_res = coll.compare(&lc, &lc + 1, &rc, &rc + 1)) != 0)
+    if (lc != rc && (cmp_res = coll.compare(&lc, &lc + 1, &rc, &rc + 1)) != 0)
     {
       return cmp_res;
     }
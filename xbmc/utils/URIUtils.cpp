@@ -489,7 +489,41 @@ CStdString URIUtils::SubstitutePath(const CStdString& strPath, bool reverse /* =
 
 bool URIUtils::IsProtocol(const std::string& url, const std::string &type)
 {
-  return StringUtils::StartsWithNoCase(url, type + "://");
+  return IsProtocol(url, type.c_str());
+}
+
+bool URIUtils::IsProtocol(const std::string& url, const char *type)
+{
+  // same as StartsWithNoCase(url, type + "://") without building the prefix
+  if (!StringUtils::StartsWithNoCase(url, type))
+    return false;
+  return url.compare(strlen(type), 3, "://") == 0;
+}
+
+/* Whether CURL would parse the path with a protocol at all. CURL turns backslashes
+ * into slashes before looking for "://", and turns local paths into zip and apk files
+ * into zip:// and apk:// urls, so this errs on the side of true. Paths for which it
+ * returns false are local paths without a protocol, and don't need to be parsed.
+ */
+static bool MayHaveProtocol(const std::string &path)
+{
+  for (size_t pos = path.find(':'); pos != std::string::npos; pos = path.find(':', pos + 1))
+  {
+    if (pos + 2 < path.size() &&
+        (path[pos + 1] == '/' || path[pos + 1] == '\\') &&
+        (path[pos + 2] == '/' || path[pos + 2] == '\\'))
+      return true;
+  }
+  return path.find(".zip") != std::string::npos || path.find(".apk") != std::string::npos;
+}
+
+/* Whether CURL parses the path with the given protocol. CURL takes the protocol from
+ * the start of the path, so only paths starting with it have to be parsed. Not for
+ * zip or apk, which CURL also makes up for local paths into such files.
+ */
+static bool IsParsedProtocol(const std::string &path, const char *protocol)
+{
+  return StringUtils::StartsWithNoCase(path, protocol) && CURL(path).IsProtocol(protocol);
 }
 
 bool URIUtils::PathStarts(const std::string& url, const char *start)
@@ -524,6 +558,9 @@ bool URIUtils::IsRemote(const CStdString& strFile)
     return false;
   }
 
+  if (!MayHaveProtocol(strFile))
+    return false;
+
   CURL url(strFile);
   if(HasParentInHostname(url))
     return IsRemote(url.GetHostName());
@@ -645,7 +682,8 @@ bool URIUtils::IsMultiPath(const CStdString& strPath)
 
 bool URIUtils::IsHD(const CStdString& strFileName)
 {
-  CURL url(strFileName);
+  if (!MayHaveProtocol(strFileName))
+    return true;
 
   if (IsStack(strFileName))
     return IsHD(CStackDirectory::GetFirstStackedFile(strFileName));
@@ -653,6 +691,7 @@ bool URIUtils::IsHD(const CStdString& strFileName)
   if (IsSpecial(strFileName))
     return IsHD(CSpecialProtocol::TranslatePath(strFileName));
 
+  CURL url(strFileName);
   if (HasParentInHostname(url))
     return IsHD(url.GetHostName());
 
@@ -711,6 +750,9 @@ bool URIUtils::IsInArchive(const CStdString &strFile)
 
 bool URIUtils::IsInAPK(const CStdString& strFile)
 {
+  if (!StringUtils::StartsWithNoCase(strFile, "apk") && strFile.find(".apk") == std::string::npos)
+    return false;
+
   CURL url(strFile);
 
   return url.IsProtocol("apk") && !url.GetFileName().empty();
@@ -718,6 +760,9 @@ bool URIUtils::IsInAPK(const CStdString& strFile)
 
 bool URIUtils::IsInZIP(const CStdString& strFile)
 {
+  if (!StringUtils::StartsWithNoCase(strFile, "zip") && strFile.find(".zip") == std::string::npos)
+    return false;
+
   CURL url(strFile);
 
   return url.IsProtocol("zip") && !url.GetFileName().empty();
@@ -725,6 +770,9 @@ bool URIUtils::IsInZIP(const CStdString& strFile)
 
 bool URIUtils::IsInRAR(const CStdString& strFile)
 {
+  if (!StringUtils::StartsWithNoCase(strFile, "rar"))
+    return false;
+
   CURL url(strFile);
 
   return url.IsProtocol("rar") && !url.GetFileName().empty();
@@ -757,26 +805,22 @@ bool URIUtils::IsSpecial(const CStdString& strFile)
 
 bool URIUtils::IsPlugin(const CStdString& strFile)
 {
-  CURL url(strFile);
-  return url.IsProtocol("plugin");
+  return IsParsedProtocol(strFile, "plugin");
 }
 
 bool URIUtils::IsScript(const CStdString& strFile)
 {
-  CURL url(strFile);
-  return url.IsProtocol("script");
+  return IsParsedProtocol(strFile, "script");
 }
 
 bool URIUtils::IsAddonsPath(const CStdString& strFile)
 {
-  CURL url(strFile);
-  return url.IsProtocol("addons");
+  return IsParsedProtocol(strFile, "addons");
 }
 
 bool URIUtils::IsSourcesPath(const CStdString& strPath)
 {
-  CURL url(strPath);
-  return url.IsProtocol("sources");
+  return IsParsedProtocol(strPath, "sources");
 }
 
 bool URIUtils::IsCDDA(const CStdString& strFile)
@@ -858,6 +902,9 @@ bool URIUtils::IsDAV(const CStdString& strFile)
 
 bool URIUtils::IsInternetStream(const std::string &path, bool bStrictCheck /* = false */)
 {
+  if (!MayHaveProtocol(path))
+    return false;
+
   const CURL pathToUrl(path);
   return IsInternetStream(pathToUrl, bStrictCheck);
 }
@@ -1003,8 +1050,7 @@ bool URIUtils::IsAndroidApp(const CStdString &path)
 
 bool URIUtils::IsLibraryFolder(const CStdString& strFile)
 {
-  CURL url(strFile);
-  return url.IsProtocol("library");
+  return IsParsedProtocol(strFile, "library");
 }
 
 bool URIUtils::IsLibraryContent(const std::string &strFile)
@@ -91,6 +91,7 @@ public:
    \sa PathStarts, PathEquals
    */
   static bool IsProtocol(const std::string& url, const std::string& type);
+  static bool IsProtocol(const std::string& url, const char *type);
 
   /*! \brief Check whether a path starts with a given start.
    Comparison is case-sensitive.
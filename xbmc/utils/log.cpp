@@ -20,11 +20,18 @@
 
 #include "log.h"
 #include "system.h"
+#include "threads/Event.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
 #include "utils/StringUtils.h"
 #include "CompileInfo.h"
 
+// pending lines are handed to the writer once this much is queued, or every WRITE_INTERVAL ms
+#define WRITE_BATCH_SIZE    (64 * 1024)
+#define WRITE_INTERVAL      100
+// lines below LOGWARNING are dropped rather than queued beyond this
+#define MAX_PENDING_SIZE    (4 * 1024 * 1024)
+
 static const char* const levelNames[] =
 {"DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "SEVERE", "FATAL", "NONE"};
 
@@ -35,6 +42,44 @@ static const char* const logLevelNames[] =
 // s_globals is used as static global with CLog global variables
 #define s_globals XBMC_GLOBAL_USE(CLog).m_globalInstance
 
+/*! \brief Thread writing the queued log lines to the log file in batches
+ */
+class CLog::CLogWriter : public CThread
+{
+public:
+  CLogWriter() : CThread("LogWriter") {}
+
+  void Wake() { m_wake.Set(); }
+
+  virtual void StopThread(bool bWait = true)
+  {
+    m_bStop = true;
+    m_wake.Set();
+    CThread::StopThread(bWait);
+  }
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      AbortableWait(m_wake, WRITE_INTERVAL);
+      CLog::Flush();
+    }
+  }
+
+private:
+  CEvent m_wake;
+};
+
+CLog::CLogGlobals::~CLogGlobals()
+{
+  // the writer is stopped in Close(), as the thread logs back into us on its way out.
+  // if we weren't closed it's still running, so leave whatever is queued to it
+  if (!m_writer && !m_pending.empty())
+    m_platform.WriteStringToLog(m_pending);
+}
+
 CLog::CLog()
 {}
 
@@ -43,11 +88,73 @@ CLog::~CLog()
 
 void CLog::Close()
 {
+  // stop the writer without holding our locks, as the thread logs its exit
+  CLogWriter *writer;
+  {
+    CSingleLock waitLock(s_globals.critSec);
+    writer = s_globals.m_writer;
+    s_globals.m_writer = NULL;
+  }
+  if (writer)
+  {
+    writer->StopThread();
+    delete writer;
+  }
+
+  Flush();
+
+  CSingleLock writeLock(s_globals.writeSec);
   CSingleLock waitLock(s_globals.critSec);
   s_globals.m_platform.CloseLogFile();
   s_globals.m_repeatLine.clear();
 }
 
+void CLog::Flush()
+{
+  // writeSec keeps batches in order, critSec is only held to take the pending lines
+  CSingleLock writeLock(s_globals.writeSec);
+  std::string lines;
+  unsigned int dropped;
+  {
+    CSingleLock waitLock(s_globals.critSec);
+    lines.swap(s_globals.m_pending);
+    dropped = s_globals.m_droppedLines;
+    s_globals.m_droppedLines = 0;
+  }
+
+  if (dropped)
+  {
+    std::string note = FormatLogString(LOGWARNING, StringUtils::Format("%u log lines were dropped as the log file couldn't keep up.", dropped));
+    lines = lines.empty() ? note : lines + "\n" + note;
+  }
+
+  if (!lines.empty())
+    s_globals.m_platform.WriteStringToLog(lines);
+}
+
+void CLog::FlushOnCrash()
+{
+  // another thread may have been stopped while holding our locks, so don't wait for them
+  CSingleTryLock writeLock(s_globals.writeSec);
+  if (!writeLock.IsOwner())
+    return;
+  CSingleTryLock waitLock(s_globals.critSec);
+  if (!waitLock.IsOwner())
+    return;
+
+  if (!s_globals.m_pending.empty())
+  {
+    s_globals.m_platform.WriteStringToLog(s_globals.m_pending);
+    s_globals.m_pending.clear();
+  }
+}
+
+unsigned int CLog::GetDroppedLines()
+{
+  CSingleLock waitLock(s_globals.critSec);
+  return s_globals.m_totalDroppedLines;
+}
+
 void CLog::Log(int loglevel, const char *format, ...)
 {
   if (IsLogLevelLogged(loglevel))
@@ -75,11 +182,15 @@ void CLog::LogFunction(int loglevel, const char* functionName, const char* forma
 
 void CLog::LogString(int logLevel, const std::string& logString)
 {
-  CSingleLock waitLock(s_globals.critSec);
   std::string strData(logString);
   StringUtils::TrimRight(strData);
-  if (!strData.empty())
+  if (strData.empty())
+    return;
+
+  // format outside of the lock, so that logging threads only contend on the queue
+  std::string line = FormatLogString(logLevel, strData);
   {
+    CSingleLock waitLock(s_globals.critSec);
     if (s_globals.m_repeatLogLevel == logLevel && s_globals.m_repeatLine == strData)
     {
       s_globals.m_repeatCount++;
@@ -90,29 +201,70 @@ void CLog::LogString(int logLevel, const std::string& logString)
       std::string strData2 = StringUtils::Format("Previous line repeats %d times.",
                                                 s_globals.m_repeatCount);
       PrintDebugString(strData2);
-      WriteLogString(s_globals.m_repeatLogLevel, strData2);
+      QueueLogString(s_globals.m_repeatLogLevel, FormatLogString(s_globals.m_repeatLogLevel, strData2));
       s_globals.m_repeatCount = 0;
     }
-    
+
     s_globals.m_repeatLine = strData;
     s_globals.m_repeatLogLevel = logLevel;
 
     PrintDebugString(strData);
 
-    WriteLogString(logLevel, strData);
+    QueueLogString(logLevel, line);
+
+    if (s_globals.m_writer && (logLevel & LOGMASK) < LOGERROR)
+    {
+      if (s_globals.m_pending.size() >= WRITE_BATCH_SIZE)
+        s_globals.m_writer->Wake();
+      return;
+    }
   }
+
+  // errors (which may precede a crash) are on disk before we return, as is everything
+  // logged while there's no writer
+  Flush();
 }
 
-bool CLog::Init(const std::string& path)
+void CLog::QueueLogString(int logLevel, const std::string& logString)
 {
-  CSingleLock waitLock(s_globals.critSec);
+  if (s_globals.m_pending.size() >= MAX_PENDING_SIZE && (logLevel & LOGMASK) < LOGWARNING)
+  {
+    s_globals.m_droppedLines++;
+    s_globals.m_totalDroppedLines++;
+    return;
+  }
 
+  if (!s_globals.m_pending.empty())
+    s_globals.m_pending += '\n';
+  s_globals.m_pending += logString;
+}
+
+bool CLog::Init(const std::string& path)
+{
   // the log folder location is initialized in the CAdvancedSettings
   // constructor and changed in CApplication::Create()
 
   std::string appName = CCompileInfo::GetAppName();
   StringUtils::ToLower(appName);
-  return s_globals.m_platform.OpenLogFile(path + appName + ".log", path + appName + ".old.log");
+  {
+    CSingleLock writeLock(s_globals.writeSec);
+    if (!s_globals.m_platform.OpenLogFile(path + appName + ".log", path + appName + ".old.log"))
+      return false;
+  }
+
+  // start the writer without holding our locks, as the thread logs its startup
+  CLogWriter *writer = new CLogWriter();
+  {
+    CSingleLock waitLock(s_globals.critSec);
+    if (s_globals.m_writer)
+    {
+      delete writer;
+      return true;
+    }
+    s_globals.m_writer = writer;
+  }
+  writer->Create();
+  return true;
 }
 
 void CLog::MemDump(char *pData, int length)
@@ -148,11 +300,13 @@ void CLog::MemDump(char *pData, int length)
 
 void CLog::SetLogLevel(int level)
 {
-  CSingleLock waitLock(s_globals.critSec);
   if (level >= LOG_LEVEL_NONE && level <= LOG_LEVEL_MAX)
   {
-    s_globals.m_logLevel = level;
-    CLog::Log(LOGNOTICE, "Log level changed to \"%s\"", logLevelNames[s_globals.m_logLevel + 1]);
+    {
+      CSingleLock waitLock(s_globals.critSec);
+      s_globals.m_logLevel = level;
+    }
+    CLog::Log(LOGNOTICE, "Log level changed to \"%s\"", logLevelNames[level + 1]);
   }
   else
     CLog::Log(LOGERROR, "%s: Invalid log level requested: %d", __FUNCTION__, level);
@@ -196,7 +350,7 @@ void CLog::PrintDebugString(const std::string& line)
 #endif // defined(_DEBUG) || defined(PROFILE)
 }
 
-bool CLog::WriteLogString(int logLevel, const std::string& logString)
+std::string CLog::FormatLogString(int logLevel, const std::string& logString)
 {
   static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%" PRIu64" %7s: ";
 
@@ -207,12 +361,10 @@ bool CLog::WriteLogString(int logLevel, const std::string& logString)
   int hour, minute, second;
   s_globals.m_platform.GetCurrentLocalTime(hour, minute, second);
   
-  strData = StringUtils::Format(prefixFormat,
-                                  hour,
-                                  minute,
-                                  second,
-                                  (uint64_t)CThread::GetCurrentThreadId(),
-                                  levelNames[logLevel]) + strData;
-
-  return s_globals.m_platform.WriteStringToLog(strData);
+  return StringUtils::Format(prefixFormat,
+                             hour,
+                             minute,
+                             second,
+                             (uint64_t)CThread::GetCurrentThreadId(),
+                             levelNames[logLevel & LOGMASK]) + strData;
 }
@@ -52,24 +52,43 @@ public:
   static int  GetLogLevel();
   static void SetExtraLogLevels(int level);
   static bool IsLogLevelLogged(int loglevel);
+  /*! \brief Write all pending lines to the log file
+   Lines are written by a background thread in batches at least every 100ms, except for errors
+   and worse which are written before Log() returns.
+   */
+  static void Flush();
+  /*! \brief Write the pending lines from a crash handler
+   Unlike Flush() this never waits, and gives up if another thread holds the log locks.
+   */
+  static void FlushOnCrash();
+  static unsigned int GetDroppedLines();
 
 protected:
+  friend class TestlogHelper;
+  class CLogWriter;
   class CLogGlobals
   {
   public:
-    CLogGlobals(void) : m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0) {}
-    ~CLogGlobals() {}
+    CLogGlobals(void) : m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0),
+                        m_droppedLines(0), m_totalDroppedLines(0), m_writer(NULL) {}
+    ~CLogGlobals();
     PlatformInterfaceForCLog m_platform;
     int         m_repeatCount;
     int         m_repeatLogLevel;
     std::string m_repeatLine;
     int         m_logLevel;
     int         m_extraLogLevels;
-    CCriticalSection critSec;
+    std::string  m_pending;           ///< \brief formatted lines waiting to be written, separated by newlines
+    unsigned int m_droppedLines;      ///< \brief lines dropped since the last write, as the writer couldn't keep up
+    unsigned int m_totalDroppedLines;
+    CLogWriter  *m_writer;
+    CCriticalSection critSec;         ///< \brief protects everything but the log file
+    CCriticalSection writeSec;        ///< \brief protects the log file, taken before critSec
   };
   class CLogGlobals m_globalInstance; // used as static global variable
   static void LogString(int logLevel, const std::string& logString);
-  static bool WriteLogString(int logLevel, const std::string& logString);
+  static void QueueLogString(int logLevel, const std::string& logString);
+  static std::string FormatLogString(int logLevel, const std::string& logString);
 };
 
 
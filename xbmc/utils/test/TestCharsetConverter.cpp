@@ -22,10 +22,16 @@
 #include "utils/CharsetConverter.h"
 #include "utils/StdString.h"
 #include "utils/Utf8Utils.h"
+#include "utils/Stopwatch.h"
+#include "threads/SingleLock.h"
 #include "system.h"
 
 #include "gtest/gtest.h"
 
+#include <iconv.h>
+#include <iostream>
+#include <stdlib.h>
+
 static const uint16_t refutf16LE1[] = { 0xff54, 0xff45, 0xff53, 0xff54,
                                         0xff3f, 0xff55, 0xff54, 0xff46,
                                         0xff11, 0xff16, 0xff2c, 0xff25,
@@ -405,3 +411,148 @@ TEST_F(TestCharsetConverter, fromW)
   g_charsetConverter.fromW(refstrw1, varstra1, "UTF-16LE");
   EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
 }
+
+TEST_F(TestCharsetConverter, utf8ToUtf32_ASCII)
+{
+  // long enough to take the word at a time path, with a tail that doesn't
+  refstra1 = "test utf8ToUtf32 with plain US-ASCII input";
+  std::u32string utf32;
+  EXPECT_TRUE(g_charsetConverter.utf8ToUtf32(refstra1, utf32));
+  ASSERT_EQ(refstra1.length(), utf32.length());
+  for (size_t i = 0; i < refstra1.length(); i++)
+    EXPECT_EQ((char32_t)refstra1[i], utf32[i]);
+}
+
+TEST_F(TestCharsetConverter, utf8ToUtf32_Multibyte)
+{
+  // one, two, three and four byte sequences, after and before US-ASCII words
+  refstra1 = "abcdefgh\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80ijklmnop";
+  std::u32string utf32;
+  EXPECT_TRUE(g_charsetConverter.utf8ToUtf32(refstra1, utf32));
+  ASSERT_EQ(19u, utf32.length());
+  EXPECT_EQ((char32_t)'h', utf32[7]);
+  EXPECT_EQ((char32_t)0xE9, utf32[8]);
+  EXPECT_EQ((char32_t)0x20AC, utf32[9]);
+  EXPECT_EQ((char32_t)0x1F600, utf32[10]);
+  EXPECT_EQ((char32_t)'i', utf32[11]);
+
+  std::string utf8;
+  EXPECT_TRUE(g_charsetConverter.utf32ToUtf8(utf32, utf8));
+  EXPECT_STREQ(refstra1.c_str(), utf8.c_str());
+}
+
+TEST_F(TestCharsetConverter, utf8ToUtf32_Malformed)
+{
+  static const char* const malformed[] = {
+    "\x80",             // lone continuation byte
+    "\xC3",             // truncated two byte sequence
+    "\xE2\x82",         // truncated three byte sequence
+    "\xC0\xAF",         // overlong '/'
+    "\xE0\x80\xAF",     // overlong '/'
+    "\xF0\x80\x80\xAF", // overlong '/'
+    "\xED\xA0\x80",     // UTF-16 surrogate
+    "\xF4\x90\x80\x80", // beyond U+10FFFF
+    "\xFE",             // never valid in UTF-8
+    "\xC3\x28"          // invalid continuation byte
+  };
+
+  for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+  {
+    const std::string input = std::string("a") + malformed[i] + "b";
+    std::u32string utf32;
+    EXPECT_FALSE(g_charsetConverter.utf8ToUtf32(input, utf32, true)) << "input " << i;
+    EXPECT_TRUE(utf32.empty()) << "input " << i;
+
+    // invalid bytes are skipped, the valid characters around them are kept
+    EXPECT_TRUE(g_charsetConverter.utf8ToUtf32(input, utf32, false)) << "input " << i;
+    std::string utf8;
+    EXPECT_TRUE(g_charsetConverter.utf32ToUtf8(utf32, utf8));
+    if (i == sizeof(malformed) / sizeof(malformed[0]) - 1)
+      EXPECT_STREQ("a(b", utf8.c_str());
+    else
+      EXPECT_STREQ("ab", utf8.c_str()) << "input " << i;
+  }
+}
+
+TEST_F(TestCharsetConverter, utf32ToUtf8_Invalid)
+{
+  std::u32string utf32;
+  utf32.push_back('a');
+  utf32.push_back(0xD800);
+  utf32.push_back(0x110000);
+  utf32.push_back('b');
+
+  std::string utf8;
+  EXPECT_FALSE(g_charsetConverter.utf32ToUtf8(utf32, utf8, true));
+  EXPECT_TRUE(utf8.empty());
+  EXPECT_TRUE(g_charsetConverter.utf32ToUtf8(utf32, utf8, false));
+  EXPECT_STREQ("ab", utf8.c_str());
+}
+
+TEST_F(TestCharsetConverter, wToUTF8_NonBMP)
+{
+  refstrw1 = L"a\U0001F600b";
+  refstra1 = "a\xF0\x9F\x98\x80" "b";
+  varstra1.clear();
+  EXPECT_TRUE(g_charsetConverter.wToUTF8(refstrw1, varstra1, true));
+  EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
+
+  varstrw1.clear();
+  EXPECT_TRUE(g_charsetConverter.utf8ToW(refstra1, varstrw1, false, false, true));
+  EXPECT_TRUE(refstrw1 == varstrw1);
+}
+
+TEST_F(TestCharsetConverter, DISABLED_Benchmark_utf8ToUtf32)
+{
+  static const char* const labels[] = {
+    "Movies",
+    "The Lord of the Rings: The Fellowship of the Ring (2001)",
+    "Beyonc\xC3\xA9 \xE2\x80\x93 Halo",
+    "\xE6\x9D\xB1\xE4\xBA\xAC\xE7\x89\xA9\xE8\xAA\x9E",
+    "Recently added episodes"
+  };
+  const size_t numLabels = sizeof(labels) / sizeof(labels[0]);
+  const unsigned int iterations = 1000000;
+  std::vector<std::string> input;
+  for (size_t i = 0; i < numLabels; i++)
+    input.push_back(labels[i]);
+
+  // the locked iconv conversion previously used for every label
+  CCriticalSection iconvSection;
+  iconv_t conv = iconv_open("UTF-32LE", "UTF-8");
+  ASSERT_NE((iconv_t)-1, conv);
+
+  CStopWatch watch;
+  watch.StartZero();
+  size_t converted = 0;
+  for (unsigned int i = 0; i < iterations; i++)
+  {
+    const std::string& str = input[i % numLabels];
+    CSingleLock lock(iconvSection);
+    size_t inBytes = str.length() + 1;
+    size_t outBytes = inBytes * sizeof(char32_t);
+    char* outBuf = (char*)malloc(outBytes);
+    char* in = (char*)str.c_str();
+    char* out = outBuf;
+    iconv(conv, &in, &inBytes, &out, &outBytes);
+    iconv(conv, NULL, NULL, &out, &outBytes);
+    std::u32string utf32((const char32_t*)outBuf, (out - outBuf) / sizeof(char32_t) - 1);
+    free(outBuf);
+    converted += utf32.length();
+  }
+  float iconvTime = watch.GetElapsedMilliseconds();
+  iconv_close(conv);
+
+  watch.StartZero();
+  for (unsigned int i = 0; i < iterations; i++)
+  {
+    std::u32string utf32;
+    g_charsetConverter.utf8ToUtf32(input[i % numLabels], utf32, false);
+    converted -= utf32.length();
+  }
+  float nativeTime = watch.GetElapsedMilliseconds();
+
+  EXPECT_EQ(0u, converted);
+  std::cout << iterations << " labels: iconv " << iconvTime << "ms, native "
+            << nativeTime << "ms" << std::endl;
+}
@@ -21,6 +21,7 @@
 #include "utils/DatabaseUtils.h"
 #include "video/VideoDatabase.h"
 #include "music/MusicDatabase.h"
+#include "dbwrappers/dataset.h"
 #include "dbwrappers/qry_dat.h"
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
@@ -1289,13 +1290,94 @@ TEST(TestDatabaseUtils, GetFieldValue)
   EXPECT_TRUE(v_string.isString());
 }
 
-/* TODO: Need some way to test this function */
-// TEST(TestDatabaseUtils, GetDatabaseResults)
-// {
-//   static bool GetDatabaseResults(MediaType mediaType, const FieldList &fields,
-//                                  const std::auto_ptr<dbiplus::Dataset> &dataset,
-//                                  DatabaseResults &results);
-// }
+/* A dataset holding a fixed result set, without any database behind it */
+class TestDatabaseUtilsDataset : public dbiplus::Dataset
+{
+public:
+  void AddColumns(unsigned int count)
+  {
+    for (unsigned int i = 0; i < count; i++)
+    {
+      dbiplus::field_prop prop;
+      prop.name = StringUtils::Format("column%u", i);
+      result.record_header.push_back(prop);
+    }
+  }
+  dbiplus::sql_record *AddRecord()
+  {
+    dbiplus::sql_record *record = new dbiplus::sql_record(result.record_header.size());
+    result.records.push_back(record);
+    return record;
+  }
+
+  virtual int num_rows() { return result.records.size(); }
+  virtual int64_t lastinsertid() { return 0; }
+  virtual long nextid(const char *seq_name) { return 0; }
+  virtual void open(const std::string &sql) {}
+  virtual void open() {}
+  virtual int exec(const std::string &sql) { return 0; }
+  virtual int exec() { return 0; }
+  virtual const void* getExecRes() { return NULL; }
+  virtual bool query(const char *sql) { return false; }
+
+protected:
+  virtual void make_insert() {}
+  virtual void make_edit() {}
+  virtual void make_deletion() {}
+  virtual void fill_fields() {}
+};
+
+static TestDatabaseUtilsDataset *CreateSongDataset(const TestDatabaseUtilsHelper &helper)
+{
+  TestDatabaseUtilsDataset *dataset = new TestDatabaseUtilsDataset();
+  dataset->AddColumns(std::max(helper.song_strTitle, helper.song_iTrack) + 1);
+  for (int i = 1; i <= 2; i++)
+  {
+    dbiplus::sql_record *record = dataset->AddRecord();
+    record->at(helper.song_strTitle) = dbiplus::field_value(StringUtils::Format("title%i", i).c_str());
+    record->at(helper.song_iTrack) = dbiplus::field_value(i);
+  }
+  return dataset;
+}
+
+TEST(TestDatabaseUtils, GetDatabaseResults_DuplicateField)
+{
+  TestDatabaseUtilsHelper helper;
+  std::auto_ptr<dbiplus::Dataset> dataset(CreateSongDataset(helper));
+
+  FieldList fields;
+  fields.push_back(FieldTitle);
+  fields.push_back(FieldTrackNumber);
+  fields.push_back(FieldTitle);
+
+  // a field asked for twice is only there once, and rows follow any results we already have
+  DatabaseResults results(1);
+  EXPECT_TRUE(DatabaseUtils::GetDatabaseResults(MediaTypeSong, fields, dataset, results));
+  ASSERT_EQ(3U, results.size());
+  for (unsigned int i = 1; i < results.size(); i++)
+  {
+    EXPECT_EQ(5U, results[i].size()); // row, title, track number, media type and label
+    EXPECT_EQ(i, results[i].at(FieldRow).asUnsignedInteger());
+    EXPECT_STREQ(StringUtils::Format("title%u", i).c_str(), results[i].at(FieldTitle).asString().c_str());
+    EXPECT_EQ(i, results[i].at(FieldTrackNumber).asUnsignedInteger());
+    EXPECT_STREQ(StringUtils::Format("%u. title%u", i, i).c_str(), results[i].at(FieldLabel).asString().c_str());
+  }
+}
+
+TEST(TestDatabaseUtils, GetDatabaseResults_InvalidField)
+{
+  TestDatabaseUtilsHelper helper;
+  std::auto_ptr<dbiplus::Dataset> dataset(CreateSongDataset(helper));
+
+  FieldList fields;
+  fields.push_back(FieldTitle);
+  fields.push_back(FieldNone);
+
+  // no rows are built for a field that isn't in the dataset
+  DatabaseResults results;
+  EXPECT_FALSE(DatabaseUtils::GetDatabaseResults(MediaTypeSong, fields, dataset, results));
+  EXPECT_TRUE(results.empty());
+}
 
 TEST(TestDatabaseUtils, BuildLimitClause)
 {
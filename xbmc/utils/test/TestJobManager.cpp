@@ -21,9 +21,13 @@
 #include "utils/JobManager.h"
 #include "settings/Settings.h"
 #include "utils/SystemInfo.h"
+#include "utils/Stopwatch.h"
+#include "threads/Atomics.h"
 
 #include "gtest/gtest.h"
 
+#include <iostream>
+
 /* CSysInfoJob::GetInternetState() will test for network connectivity. */
 class TestJobManager : public testing::Test
 {
@@ -177,3 +181,176 @@ TEST_F(TestJobManager, IsProcessing)
 
   job->FinishAndStopBlocking();
 }
+
+namespace
+{
+class CountingJob : public CJob
+{
+public:
+  CountingJob(volatile long *destroyed = NULL) : m_destroyed(destroyed) {}
+  virtual ~CountingJob()
+  {
+    if (m_destroyed)
+      AtomicIncrement(m_destroyed);
+  }
+  const char * GetType() const { return "CountingJob"; }
+  bool DoWork() { return true; }
+private:
+  volatile long *m_destroyed;
+};
+
+class CountingCallback : public IJobCallback
+{
+public:
+  CountingCallback() : m_completed(0) {}
+  void OnJobComplete(unsigned int jobID, bool success, CJob *job) { AtomicIncrement(&m_completed); }
+  volatile long m_completed;
+};
+
+bool WaitForJobs(CountingCallback &callback, long count, unsigned int milliseconds)
+{
+  XbmcThreads::EndTime timeout(milliseconds);
+  while (callback.m_completed < count && !timeout.IsTimePast())
+    XbmcThreads::ThreadSleep(1);
+  return callback.m_completed >= count;
+}
+}
+
+TEST_F(TestJobManager, CancelQueuedJob)
+{
+  volatile long destroyed = 0;
+  CJobManager::GetInstance().PauseJobs();
+  unsigned int id = CJobManager::GetInstance().AddJob(new CountingJob(&destroyed), NULL, CJob::PRIORITY_LOW_PAUSABLE);
+  EXPECT_EQ(0, destroyed);
+
+  // a queued job is destroyed on cancelling it, without being processed
+  CJobManager::GetInstance().CancelJob(id);
+  EXPECT_EQ(1, destroyed);
+  CJobManager::GetInstance().CancelJob(id);
+  EXPECT_EQ(1, destroyed);
+  CJobManager::GetInstance().UnPauseJobs();
+}
+
+TEST_F(TestJobManager, QueueLatencies)
+{
+  std::vector<unsigned int> before, after;
+  CJobManager::GetInstance().GetQueueLatencies(CJob::PRIORITY_NORMAL, before);
+  ASSERT_EQ((size_t)CJobManager::LATENCY_BUCKETS, before.size());
+
+  CountingCallback callback;
+  for (int i = 0; i < 10; i++)
+    CJobManager::GetInstance().AddJob(new CountingJob(), &callback, CJob::PRIORITY_NORMAL);
+  ASSERT_TRUE(WaitForJobs(callback, 10, 10000));
+
+  CJobManager::GetInstance().GetQueueLatencies(CJob::PRIORITY_NORMAL, after);
+  unsigned int counted = 0;
+  for (unsigned int i = 0; i < after.size(); i++)
+    counted += after[i] - before[i];
+  EXPECT_EQ(10u, counted);
+}
+
+class TestJobManagerHelper
+{
+public:
+  static CJob::PRIORITY GetEffectivePriority(CJob::PRIORITY priority, unsigned int waited)
+  {
+    return CJobManager::GetEffectivePriority(priority, waited);
+  }
+  static bool IsPreferred(CJob::PRIORITY priority, unsigned int waited, CJob::PRIORITY otherPriority, unsigned int otherWaited)
+  {
+    return CJobManager::IsPreferred(priority, waited, otherPriority, otherWaited);
+  }
+  static unsigned int GetMaxWorkers(CJob::PRIORITY priority)
+  {
+    return CJobManager::GetMaxWorkers(priority);
+  }
+};
+
+TEST_F(TestJobManager, Aging)
+{
+  const unsigned int interval = CJobManager::AGING_INTERVAL;
+
+  // jobs rise a priority per interval, up to normal
+  EXPECT_EQ(CJob::PRIORITY_LOW_PAUSABLE, TestJobManagerHelper::GetEffectivePriority(CJob::PRIORITY_LOW_PAUSABLE, interval - 1));
+  EXPECT_EQ(CJob::PRIORITY_LOW, TestJobManagerHelper::GetEffectivePriority(CJob::PRIORITY_LOW_PAUSABLE, interval));
+  EXPECT_EQ(CJob::PRIORITY_NORMAL, TestJobManagerHelper::GetEffectivePriority(CJob::PRIORITY_LOW_PAUSABLE, 2 * interval));
+  EXPECT_EQ(CJob::PRIORITY_NORMAL, TestJobManagerHelper::GetEffectivePriority(CJob::PRIORITY_LOW_PAUSABLE, 100 * interval));
+  EXPECT_EQ(CJob::PRIORITY_NORMAL, TestJobManagerHelper::GetEffectivePriority(CJob::PRIORITY_NORMAL, 100 * interval));
+  EXPECT_EQ(CJob::PRIORITY_HIGH, TestJobManagerHelper::GetEffectivePriority(CJob::PRIORITY_HIGH, 0));
+
+  // an aged job overtakes fresh jobs of a lower effective priority
+  EXPECT_TRUE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_LOW_PAUSABLE, 2 * interval, CJob::PRIORITY_LOW, 0));
+  EXPECT_FALSE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_LOW, 0, CJob::PRIORITY_LOW_PAUSABLE, 2 * interval));
+  EXPECT_TRUE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_LOW, 0, CJob::PRIORITY_LOW_PAUSABLE, interval - 1));
+
+  // and higher priority jobs queued after it reached their priority
+  EXPECT_TRUE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_LOW_PAUSABLE, 2 * interval + 20, CJob::PRIORITY_NORMAL, 10));
+  EXPECT_FALSE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_NORMAL, 10, CJob::PRIORITY_LOW_PAUSABLE, 2 * interval + 20));
+  EXPECT_TRUE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_LOW, interval + 20, CJob::PRIORITY_NORMAL, 10));
+
+  // but not those queued before
+  EXPECT_TRUE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_NORMAL, 30, CJob::PRIORITY_LOW_PAUSABLE, 2 * interval + 20));
+  EXPECT_FALSE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_LOW, interval + 20, CJob::PRIORITY_NORMAL, 30));
+
+  // nothing ages past normal, so high priority jobs always go first
+  EXPECT_TRUE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_HIGH, 0, CJob::PRIORITY_LOW, 100 * interval));
+  EXPECT_TRUE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_HIGH, 0, CJob::PRIORITY_NORMAL, 100 * interval));
+
+  // of the same priority, the job that waited longest goes first
+  EXPECT_TRUE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_LOW, 20, CJob::PRIORITY_LOW, 10));
+  EXPECT_FALSE(TestJobManagerHelper::IsPreferred(CJob::PRIORITY_LOW, 10, CJob::PRIORITY_LOW, 20));
+
+  // an aged job may use the workers of normal priority jobs, but not the one kept for high priority jobs
+  EXPECT_EQ(TestJobManagerHelper::GetMaxWorkers(CJob::PRIORITY_NORMAL),
+            TestJobManagerHelper::GetMaxWorkers(TestJobManagerHelper::GetEffectivePriority(CJob::PRIORITY_LOW_PAUSABLE, 100 * interval)));
+  EXPECT_LT(TestJobManagerHelper::GetMaxWorkers(CJob::PRIORITY_NORMAL), TestJobManagerHelper::GetMaxWorkers(CJob::PRIORITY_HIGH));
+}
+
+TEST_F(TestJobManager, WorkerLimits)
+{
+  // keep as many workers busy as low priority jobs may use
+  JobControlPackage packages[3];
+  BroadcastingJob *jobs[3];
+  for (int i = 0; i < 3; i++)
+    jobs[i] = WaitForJobToStartProcessing(CJob::PRIORITY_HIGH, packages[i]);
+
+  // a low priority job has to wait for one of them to finish
+  CountingCallback callback;
+  CJobManager::GetInstance().AddJob(new CountingJob(), &callback, CJob::PRIORITY_LOW);
+  EXPECT_FALSE(WaitForJobs(callback, 1, 100));
+
+  // while a normal priority job can still use the workers kept free for it
+  CJobManager::GetInstance().AddJob(new CountingJob(), &callback, CJob::PRIORITY_NORMAL);
+  EXPECT_TRUE(WaitForJobs(callback, 1, 10000));
+
+  for (int i = 0; i < 3; i++)
+    jobs[i]->FinishAndStopBlocking();
+  EXPECT_TRUE(WaitForJobs(callback, 2, 10000));
+}
+
+TEST_F(TestJobManager, DISABLED_Benchmark_Throughput)
+{
+  static const CJob::PRIORITY priorities[] = { CJob::PRIORITY_LOW_PAUSABLE, CJob::PRIORITY_LOW,
+                                               CJob::PRIORITY_NORMAL, CJob::PRIORITY_HIGH };
+  const long jobs = 100000;
+  CountingCallback callback;
+
+  CStopWatch watch;
+  watch.StartZero();
+  for (long i = 0; i < jobs; i++)
+    CJobManager::GetInstance().AddJob(new CountingJob(), &callback, priorities[i % 4]);
+  float queued = watch.GetElapsedMilliseconds();
+  EXPECT_TRUE(WaitForJobs(callback, jobs, 120000));
+  float completed = watch.GetElapsedMilliseconds();
+
+  std::cout << jobs << " jobs: " << queued << "ms queued, " << completed << "ms completed" << std::endl;
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; priority++)
+  {
+    std::vector<unsigned int> buckets;
+    CJobManager::GetInstance().GetQueueLatencies((CJob::PRIORITY)priority, buckets);
+    std::cout << "priority " << priority << " latencies (<1ms, <2ms, ...):";
+    for (unsigned int i = 0; i < buckets.size(); i++)
+      std::cout << " " << buckets[i];
+    std::cout << std::endl;
+  }
+}
@@ -29,8 +29,12 @@
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
 #include "utils/StringUtils.h"
+#include "utils/Stopwatch.h"
+#include "settings/AdvancedSettings.h"
 #include "CompileInfo.h"
 
+#include <iostream>
+
 TEST(TestRegExp, RegFind)
 {
   CRegExp regex;
@@ -135,6 +139,69 @@ TEST(TestRegExp, operatorEqual)
   EXPECT_STREQ("string", match.c_str());
 }
 
+TEST(TestRegExp, SharedPattern)
+{
+  CRegExp regex(true, CRegExp::autoUtf8), other(true, CRegExp::autoUtf8);
+
+  EXPECT_TRUE(regex.RegComp("s([0-9]+)e([0-9]+)", CRegExp::StudyWithJitComp));
+  EXPECT_TRUE(other.RegComp("s([0-9]+)e([0-9]+)", CRegExp::StudyWithJitComp));
+  EXPECT_EQ(5, regex.RegFind("Show.S01E02.mkv"));
+  EXPECT_EQ(0, other.RegFind("s10e20"));
+
+  // both share the compiled expression, but keep their own matches
+  EXPECT_STREQ("01", regex.GetMatch(1).c_str());
+  EXPECT_STREQ("02", regex.GetMatch(2).c_str());
+  EXPECT_STREQ("10", other.GetMatch(1).c_str());
+  EXPECT_STREQ("20", other.GetMatch(2).c_str());
+
+  // the shared expression outlives the object that compiled it
+  CRegExp copy(regex);
+  regex.RegComp("^Test");
+  EXPECT_STREQ("01", copy.GetMatch(1).c_str());
+  EXPECT_EQ(3, copy.RegFind("TV/s3e4"));
+  EXPECT_STREQ("3", copy.GetMatch(1).c_str());
+  EXPECT_EQ(-1, regex.RegFind("TV/s3e4"));
+}
+
+TEST(TestRegExp, DISABLED_Benchmark_TVShowMatching)
+{
+  g_advancedSettings.OnSettingsUnloaded();
+  g_advancedSettings.Initialize();
+  const SETTINGS_TVSHOWLIST &expressions = g_advancedSettings.m_tvshowEnumRegExps;
+
+  std::vector<std::string> files;
+  for (int i = 0; i < 100000; i++)
+  {
+    switch (i % 4)
+    {
+      case 0: files.push_back(StringUtils::Format("/tv/Show %d/Season %d/Show.%d.S%02dE%02d.720p.mkv", i % 97, i % 9, i, i % 9, i % 24)); break;
+      case 1: files.push_back(StringUtils::Format("/tv/Show %d/Show %d - %dx%02d - Title.avi", i % 97, i, i % 9, i % 24)); break;
+      case 2: files.push_back(StringUtils::Format("/tv/Daily %d/daily.%d.2013.%02d.%02d.mp4", i % 97, i, i % 12 + 1, i % 28 + 1)); break;
+      default: files.push_back(StringUtils::Format("/movies/Some Movie %d (2013)/movie.%d.mkv", i, i)); break;
+    }
+  }
+
+  // compile every expression for every file, like CVideoInfoScanner::EnumerateEpisodeItem does
+  unsigned int matched = 0;
+  CStopWatch watch;
+  watch.StartZero();
+  for (size_t i = 0; i < files.size(); i++)
+  {
+    for (size_t j = 0; j < expressions.size(); j++)
+    {
+      CRegExp reg(true, CRegExp::autoUtf8);
+      if (reg.RegComp(expressions[j].regexp, CRegExp::StudyWithJitComp) && reg.RegFind(files[i]) >= 0)
+      {
+        matched++;
+        break;
+      }
+    }
+  }
+  std::cout << files.size() << " files against " << expressions.size() << " expressions: "
+            << matched << " matched in " << watch.GetElapsedMilliseconds() << "ms"
+            << (CRegExp::IsJitSupported() ? " (JIT)" : "") << std::endl;
+}
+
 class TestRegExpLog : public testing::Test
 {
 protected:
@@ -19,6 +19,8 @@
  */
 
 #include "utils/SortUtils.h"
+#include "utils/Stopwatch.h"
+#include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
 #include "gtest/gtest.h"
@@ -131,3 +133,82 @@ TEST(TestSortUtils, GetFieldsForSorting)
   EXPECT_EQ(FieldTrackNumber, *it);
   EXPECT_EQ((unsigned int)4, fields.size());
 }
+
+static SortItemPtr CreateSong(int i)
+{
+  SortItemPtr item(new SortItem());
+  (*item)[FieldLabel] = StringUtils::Format("%02i. Song %i", i % 20 + 1, i);
+  (*item)[FieldTitle] = StringUtils::Format("The Song %i", (i * 7919) % 200000);
+  (*item)[FieldArtist] = StringUtils::Format("Artist %i", (i * 31) % 5000);
+  (*item)[FieldAlbum] = StringUtils::Format("Album %i", i / 20);
+  (*item)[FieldTrackNumber] = i % 20 + 1;
+  (*item)[FieldTime] = 120 + (i * 13) % 300;
+  (*item)[FieldYear] = 1960 + (i / 20) % 50;
+  (*item)[FieldGenre] = StringUtils::Format("Genre %i", (i / 20) % 30);
+  (*item)[FieldPlaycount] = (i * 17) % 50;
+  (*item)[FieldRating] = (i * 3) % 6;
+  (*item)[FieldDateAdded] = StringUtils::Format("20%02i-%02i-%02i 12:00:00", 10 + i % 4, i % 12 + 1, i % 28 + 1);
+  (*item)[FieldFolder] = false;
+  return item;
+}
+
+TEST(TestSortUtils, Sort_Limits)
+{
+  SortItems items;
+  for (int i = 0; i < 100; i++)
+    items.push_back(CreateSong(i));
+  SortItems limited(items);
+
+  // a partial sort must give the same items as sorting everything and cutting out the range
+  SortUtils::Sort(SortByTitle, SortOrderDescending, SortAttributeIgnoreArticle, items);
+  SortUtils::Sort(SortByTitle, SortOrderDescending, SortAttributeIgnoreArticle, limited, 30, 10);
+
+  ASSERT_EQ((size_t)20, limited.size());
+  for (size_t i = 0; i < limited.size(); i++)
+    EXPECT_EQ(items[i + 10], limited[i]);
+}
+
+TEST(TestSortUtils, Sort_Stable)
+{
+  SortItems items;
+  for (int i = 0; i < 100; i++)
+  {
+    SortItemPtr item(new SortItem());
+    (*item)[FieldTrackNumber] = i % 2;
+    (*item)[FieldLabel] = i;
+    items.push_back(item);
+  }
+
+  SortUtils::Sort(SortByTrackNumber, SortOrderAscending, SortAttributeNone, items);
+
+  // items with the same track number keep their order
+  for (size_t i = 1; i < items.size(); i++)
+  {
+    if ((*items[i - 1])[FieldTrackNumber].asInteger() == (*items[i])[FieldTrackNumber].asInteger())
+      EXPECT_LT((*items[i - 1])[FieldLabel].asInteger(), (*items[i])[FieldLabel].asInteger());
+  }
+}
+
+/* Benchmark sorting a large library by every method, run with --gtest_also_run_disabled_tests */
+TEST(TestSortUtils, DISABLED_Benchmark_Sort)
+{
+  SortItems songs;
+  for (int i = 0; i < 200000; i++)
+    songs.push_back(CreateSong(i));
+
+  for (int sortBy = SortByLabel; sortBy <= SortByDateTaken; sortBy++)
+  {
+    SortItems items(songs);
+    CStopWatch watch;
+    watch.StartZero();
+    SortUtils::Sort((SortBy)sortBy, SortOrderAscending, SortAttributeIgnoreArticle, items);
+    float full = watch.GetElapsedMilliseconds();
+
+    items = songs;
+    watch.StartZero();
+    SortUtils::Sort((SortBy)sortBy, SortOrderAscending, SortAttributeIgnoreArticle, items, 50);
+    float limited = watch.GetElapsedMilliseconds();
+
+    std::cout << "SortBy " << sortBy << ": " << full << "ms, first 50: " << limited << "ms" << std::endl;
+  }
+}
@@ -20,11 +20,19 @@
 
 #include "utils/URIUtils.h"
 #include "settings/AdvancedSettings.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
 #include "filesystem/MultiPathDirectory.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/SystemClock.h"
+#include "utils/StringUtils.h"
+#include "FileItem.h"
 #include "URL.h"
 
 #include "gtest/gtest.h"
 
+#include <iostream>
+
 using namespace XFILE;
 
 class TestURIUtils : public testing::Test
@@ -620,3 +628,64 @@ TEST_F(TestURIUtils, UpdateUrlEncoding)
   EXPECT_FALSE(URIUtils::UpdateUrlEncoding(oldUrl));
   EXPECT_STRCASEEQ(newUrl.c_str(), oldUrl.c_str());
 }
+
+TEST_F(TestURIUtils, ProtocolWithoutParsing)
+{
+  EXPECT_TRUE(URIUtils::IsProtocol("SMB://server/share", "smb"));
+  EXPECT_FALSE(URIUtils::IsProtocol("smb:/server/share", "smb"));
+  EXPECT_FALSE(URIUtils::IsProtocol("smb", "smb"));
+  EXPECT_FALSE(URIUtils::IsProtocol("smbx://server/share", "smb"));
+
+  EXPECT_TRUE(URIUtils::IsPlugin("PLUGIN://plugin.video.test/"));
+  EXPECT_FALSE(URIUtils::IsPlugin("/path/to/plugin/file"));
+  EXPECT_FALSE(URIUtils::IsPlugin("plugins://path/to/file"));
+  EXPECT_TRUE(URIUtils::IsInZIP("Zip://path/to/file"));
+  EXPECT_FALSE(URIUtils::IsInZIP("/path/to/file.avi"));
+  EXPECT_FALSE(URIUtils::IsInRAR("/path/to/rar/file.avi"));
+
+  EXPECT_FALSE(URIUtils::IsRemote("/path/to/file"));
+  EXPECT_TRUE(URIUtils::IsRemote("smb:\\\\server\\share\\file"));
+  EXPECT_TRUE(URIUtils::IsHD("/path/to/http/file"));
+  EXPECT_FALSE(URIUtils::IsHD("smb://server/share/file"));
+  EXPECT_FALSE(URIUtils::IsInternetStream("/path/to/http/file"));
+  EXPECT_TRUE(URIUtils::IsInternetStream("HTTP://path/to/file"));
+}
+
+TEST_F(TestURIUtils, DISABLED_Benchmark_LargeDirectory)
+{
+  const int count = 50000;
+  std::string path = CSpecialProtocol::TranslatePath("special://temp/");
+  path = URIUtils::AddFileToFolder(path, "TestURIUtilsBenchmark");
+  ASSERT_TRUE(CDirectory::Create(path));
+  for (int i = 0; i < count; i++)
+  {
+    CFile file;
+    ASSERT_TRUE(file.OpenForWrite(URIUtils::AddFileToFolder(path, StringUtils::Format("file%05i.avi", i)), true));
+    file.Close();
+  }
+
+  CFileItemList items;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  EXPECT_TRUE(CDirectory::GetDirectory(path, items, ".avi|.mkv", DIR_FLAG_BYPASS_CACHE));
+  unsigned int listed = XbmcThreads::SystemClockMillis();
+
+  int matches = 0;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    const std::string &itemPath = items[i]->GetPath();
+    if (URIUtils::IsInArchive(itemPath) || URIUtils::IsRemote(itemPath) ||
+        !URIUtils::IsHD(itemPath) || URIUtils::IsInternetStream(itemPath) ||
+        URIUtils::IsPlugin(itemPath) || URIUtils::IsAddonsPath(itemPath))
+      matches++;
+  }
+  unsigned int checked = XbmcThreads::SystemClockMillis();
+
+  EXPECT_EQ(count, items.Size());
+  EXPECT_EQ(0, matches);
+  std::cout << items.Size() << " items: GetDirectory " << listed - start << "ms, path predicates "
+            << checked - listed << "ms" << std::endl;
+
+  for (int i = 0; i < items.Size(); i++)
+    CFile::Delete(items[i]->GetPath());
+  EXPECT_TRUE(CDirectory::Remove(path));
+}
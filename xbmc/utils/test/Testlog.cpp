@@ -24,12 +24,70 @@
 #include "filesystem/SpecialProtocol.h"
 #include "utils/StdString.h"
 #include "utils/StringUtils.h"
+#include "utils/Stopwatch.h"
+#include "threads/test/TestHelpers.h"
 #include "CompileInfo.h"
 
+#include <iostream>
+#include <vector>
+
 #include "test/TestUtils.h"
 
 #include "gtest/gtest.h"
 
+class LogWriterRunnable : public IRunnable
+{
+public:
+  LogWriterRunnable(int id, int lines) : m_id(id), m_lines(lines) {}
+  void Run()
+  {
+    for (int i = 0; i < m_lines; i++)
+      CLog::Log(LOGDEBUG, "concurrent log line %d from writer %d", i, m_id);
+  }
+private:
+  int m_id;
+  int m_lines;
+};
+
+static void RunLogWriters(int numThreads, int lines)
+{
+  std::vector<LogWriterRunnable*> writers;
+  std::vector<thread> threads;
+  for (int i = 0; i < numThreads; i++)
+    writers.push_back(new LogWriterRunnable(i, lines));
+  for (int i = 0; i < numThreads; i++)
+    threads.push_back(thread(*writers[i]));
+  for (int i = 0; i < numThreads; i++)
+    threads[i].join();
+  for (int i = 0; i < numThreads; i++)
+    delete writers[i];
+}
+
+class TestlogHelper
+{
+public:
+  // holding the log file lock keeps the writer from taking the pending lines
+  static CCriticalSection& GetWriteSection() { return XBMC_GLOBAL_USE(CLog).m_globalInstance.writeSec; }
+};
+
+static CStdString ReadLogFile(const CStdString& logfile)
+{
+  CStdString logstring;
+  char buf[4096];
+  unsigned int bytesread;
+  XFILE::CFile file;
+  if (file.Open(logfile))
+  {
+    while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+    {
+      buf[bytesread] = '\0';
+      logstring.append(buf);
+    }
+    file.Close();
+  }
+  return logstring;
+}
+
 class Testlog : public testing::Test
 {
 protected:
@@ -151,3 +209,116 @@ TEST_F(Testlog, SetLogLevel)
   CLog::Close();
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
+
+TEST_F(Testlog, ConcurrentWriters)
+{
+  CStdString logfile, logstring;
+  char buf[4096];
+  unsigned int bytesread;
+  XFILE::CFile file;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+  EXPECT_TRUE(XFILE::CFile::Exists(logfile));
+
+  RunLogWriters(8, 100);
+  CLog::Close();
+
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+
+  // every line must make it to disk exactly once and in one piece
+  EXPECT_EQ(800, StringUtils::FindNumber(logstring, "concurrent log line"));
+  EXPECT_EQ(0u, CLog::GetDroppedLines());
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+TEST_F(Testlog, DISABLED_Benchmark_Contention)
+{
+  CStdString logfile;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+
+  CStopWatch watch;
+  watch.StartZero();
+  RunLogWriters(16, 20000);
+  float queued = watch.GetElapsedMilliseconds();
+  CLog::Close();
+  float total = watch.GetElapsedMilliseconds();
+
+  std::cout << "16 threads x 20000 lines: " << queued << "ms queued, "
+            << total << "ms written, "
+            << CLog::GetDroppedLines() << " lines dropped" << std::endl;
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+TEST_F(Testlog, NormalLevel_Async)
+{
+  CStdString logfile;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+  CLog::SetLogLevel(LOG_LEVEL_NORMAL);
+
+  // below LOGERROR the line is only queued, so the writer thread has to get it to disk
+  CLog::Log(LOGNOTICE, "queued notice log message");
+  bool written = false;
+  for (int i = 0; i < 100 && !written; i++)
+  {
+    XbmcThreads::ThreadSleep(20);
+    written = ReadLogFile(logfile).find("queued notice log message") != std::string::npos;
+  }
+  EXPECT_TRUE(written);
+
+  CLog::SetLogLevel(LOG_LEVEL_DEBUG);
+  CLog::Close();
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+TEST_F(Testlog, NormalLevel_DroppedLines)
+{
+  CStdString logfile, logstring;
+  const int lines = 8000;
+  const std::string padding(1000, 'x');
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+  CLog::SetLogLevel(LOG_LEVEL_NORMAL);
+  unsigned int droppedBefore = CLog::GetDroppedLines();
+
+  // queue about twice the pending limit while the writer is held up
+  {
+    CSingleLock lock(TestlogHelper::GetWriteSection());
+    for (int i = 0; i < lines; i++)
+      CLog::Log(LOGNOTICE, "stalled log line %d %s", i, padding.c_str());
+  }
+  unsigned int dropped = CLog::GetDroppedLines() - droppedBefore;
+
+  CLog::SetLogLevel(LOG_LEVEL_DEBUG);
+  CLog::Close();
+  logstring = ReadLogFile(logfile);
+
+  // every line is either on disk or counted as dropped, and the drop is noted in the log
+  EXPECT_GT(dropped, 0u);
+  EXPECT_LT(dropped, (unsigned int)lines);
+  EXPECT_EQ(lines, StringUtils::FindNumber(logstring, "stalled log line") + (int)dropped);
+  EXPECT_NE(std::string::npos, logstring.find(StringUtils::Format("%u log lines were dropped", dropped)));
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
@@ -948,7 +948,7 @@ namespace VIDEO
     for (unsigned int i=0;i<expression.size();++i)
     {
       CRegExp reg(true, CRegExp::autoUtf8);
-      if (!reg.RegComp(expression[i].regexp))
+      if (!reg.RegComp(expression[i].regexp, CRegExp::StudyWithJitComp))
         continue;
 
       int regexppos, regexp2pos;
@@ -1018,7 +1018,7 @@ namespace VIDEO
 
       CRegExp reg2(true, CRegExp::autoUtf8);
       // check the remainder of the string for any further episodes.
-      if (!byDate && reg2.RegComp(g_advancedSettings.m_tvshowMultiPartEnumRegExp))
+      if (!byDate && reg2.RegComp(g_advancedSettings.m_tvshowMultiPartEnumRegExp, CRegExp::StudyWithJitComp))
       {
         int offset = 0;
 
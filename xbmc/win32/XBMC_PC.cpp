@@ -45,6 +45,7 @@ LONG WINAPI CreateMiniDump( EXCEPTION_POINTERS* pEp )
 {
   win32_exception::write_stacktrace(pEp);
   win32_exception::write_minidump(pEp);
+  CLog::FlushOnCrash();
   return pEp->ExceptionRecord->ExceptionCode;;
 }
 
@@ -239,6 +240,9 @@ INT WINAPI WinMain( HINSTANCE hInst, HINSTANCE, LPSTR commandLine, INT )
 
   g_application.Run();
 
+  // stop the log writer while everything it logs into is still around
+  CLog::Close();
+
   // clear previously set timer resolution
   timeEndPeriod(1);		
 
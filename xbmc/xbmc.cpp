@@ -20,6 +20,7 @@
 
 #include "Application.h"
 #include "settings/AdvancedSettings.h"
+#include "utils/log.h"
 
 #ifdef TARGET_RASPBERRY_PI
 #include "linux/RBP.h"
@@ -78,5 +79,8 @@ extern "C" int XBMC_Run(bool renderGUI)
   g_RBP.Deinitialize();
 #endif
 
+  // stop the log writer while everything it logs into is still around
+  CLog::Close();
+
   return status;
 }